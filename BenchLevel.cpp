@@ -0,0 +1,28 @@
+#include "BenchLevel.hpp"
+#include "data_path.hpp"
+
+std::vector< ColliderName > const collider_names{
+	{"Block.Dark", "Block.Simple", true},
+	{"Block.Light", "Block.Simple", true},
+	{"GoalPost", "GoalPost", false},
+	{"Round.Quarter", "Round.Quarter", false},
+	{"Round.Corner", "Round.Corner", false},
+	{"Round.Corner.Outer", "Round.Corner.Outer", false},
+};
+
+BenchLevel::BenchLevel(std::string const &scene_file, MeshData const &meshes, bool distance_field) : name(scene_file) {
+	scene.load(data_path(scene_file), [&](Scene &, Scene::Transform *transform, std::string const &mesh_name){
+		for (auto const &names : collider_names) {
+			if (names.mesh != mesh_name) continue;
+			auto f = meshes.meshes.find(names.collider);
+			if (f == meshes.meshes.end()) continue;
+			if (names.box) {
+				collision.add_primitive(transform, CollisionPrimitive::box(f->second.min, f->second.max));
+			} else {
+				collision.add_mesh(transform, f->second, meshes);
+			}
+		}
+	});
+	collision.bake();
+	if (distance_field) collision.build_distance_field();
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+/*
+ * A BenchLevel is a level's scene and collision, loaded without a window or
+ *  GL context -- shared by the headless collision tools (collision-bench and
+ *  collision-replay).
+ *
+ * Which meshes collide (and as what) mirrors the tables in RollLevel.cpp and FlyLevel.cpp.
+ *
+ */
+
+#include "CollisionWorld.hpp"
+#include "Mesh.hpp"
+#include "Scene.hpp"
+
+#include <string>
+#include <vector>
+
+//which meshes collide, and as what:
+// (meshes missing from a file are skipped)
+struct ColliderName {
+	std::string mesh; //mesh in the scene
+	std::string collider; //mesh it collides as
+	bool box; //collide as a box with the collider mesh's bounds instead
+};
+extern std::vector< ColliderName > const collider_names;
+
+struct BenchLevel {
+	//(builds a distance field too if 'distance_field' is set, as FlyMode does when it is switched on)
+	BenchLevel(std::string const &scene_file, MeshData const &meshes, bool distance_field);
+	std::string name;
+	Scene scene;
+	CollisionWorld collision;
+};
@@ -0,0 +1,79 @@
+#include "ColliderGrid.hpp"
+
+#include <cassert>
+#include <cmath>
+
+ColliderGrid::ColliderGrid(float cell_size_) : cell_size(cell_size_) {
+	assert(cell_size > 0.0f);
+}
+
+glm::ivec3 ColliderGrid::cell_of(glm::vec3 const &pt) const {
+	//clamp to keep cells representable in key_of's 21-bit fields:
+	glm::vec3 c = glm::clamp(glm::floor(pt / cell_size), glm::vec3(-1048576.0f), glm::vec3(1048575.0f));
+	return glm::ivec3(c);
+}
+
+uint64_t ColliderGrid::key_of(glm::ivec3 const &cell) {
+	return (uint64_t(uint32_t(cell.x) & 0x1fffff))
+	     | (uint64_t(uint32_t(cell.y) & 0x1fffff) << 21)
+	     | (uint64_t(uint32_t(cell.z) & 0x1fffff) << 42);
+}
+
+void ColliderGrid::update(uint32_t id, glm::vec3 const &min, glm::vec3 const &max) {
+	remove(id);
+
+	if (id >= entries.size()) {
+		entries.resize(id + 1);
+	}
+
+	Entry &e = entries[id];
+	e.present = true;
+	e.min = min;
+	e.max = max;
+	e.cell_min = cell_of(min);
+	e.cell_max = cell_of(max);
+
+	glm::vec3 c_count = glm::vec3(e.cell_max - e.cell_min) + glm::vec3(1.0f);
+	e.oversize = (c_count.x * c_count.y * c_count.z > float(MaxCellsPerEntry));
+	if (e.oversize) {
+		oversize.emplace_back(id);
+		return;
+	}
+
+	for (int32_t z = e.cell_min.z; z <= e.cell_max.z; ++z) {
+		for (int32_t y = e.cell_min.y; y <= e.cell_max.y; ++y) {
+			for (int32_t x = e.cell_min.x; x <= e.cell_max.x; ++x) {
+				cells[key_of(glm::ivec3(x,y,z))].emplace_back(id);
+			}
+		}
+	}
+}
+
+void ColliderGrid::remove(uint32_t id) {
+	if (id >= entries.size() || !entries[id].present) return;
+	Entry &e = entries[id];
+
+	auto erase_from = [id](std::vector< uint32_t > &list) {
+		auto f = std::find(list.begin(), list.end(), id);
+		assert(f != list.end());
+		*f = list.back();
+		list.pop_back();
+	};
+
+	if (e.oversize) {
+		erase_from(oversize);
+	} else {
+		for (int32_t z = e.cell_min.z; z <= e.cell_max.z; ++z) {
+			for (int32_t y = e.cell_min.y; y <= e.cell_max.y; ++y) {
+				for (int32_t x = e.cell_min.x; x <= e.cell_max.x; ++x) {
+					auto f = cells.find(key_of(glm::ivec3(x,y,z)));
+					assert(f != cells.end());
+					erase_from(f->second);
+					if (f->second.empty()) cells.erase(f);
+				}
+			}
+		}
+	}
+
+	e.present = false;
+}
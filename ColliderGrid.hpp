@@ -0,0 +1,102 @@
+#pragma once
+
+/*
+ * A ColliderGrid is a broadphase structure that stores world-space
+ *  bounding boxes (identified by small integer ids) in a hashed uniform grid.
+ *
+ * Queries only look at the grid cells covered by the query box, so their
+ *  cost depends on how many entries are nearby, not on how many there are.
+ *
+ * Entries are expected to move rarely; call update() when one does.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+struct ColliderGrid {
+	ColliderGrid(float cell_size = 8.0f);
+
+	//add or move entry 'id' so it covers world-space box [min,max]:
+	void update(uint32_t id, glm::vec3 const &min, glm::vec3 const &max);
+
+	//remove entry 'id' (if present):
+	void remove(uint32_t id);
+
+	//call 'fn(uint32_t id)' exactly once for each entry whose box overlaps [min,max]:
+	// (queries don't modify the grid, so may run from several threads at once)
+	template< typename F >
+	void for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const;
+
+	//-- internals --
+
+	float cell_size;
+
+	struct Entry {
+		bool present = false;
+		bool oversize = false; //entry covers too many cells; stored in 'oversize' list instead
+		glm::vec3 min = glm::vec3(0.0f);
+		glm::vec3 max = glm::vec3(0.0f);
+		glm::ivec3 cell_min = glm::ivec3(0);
+		glm::ivec3 cell_max = glm::ivec3(0);
+	};
+	std::vector< Entry > entries; //indexed by id
+
+	//cell key -> ids of entries overlapping that cell:
+	std::unordered_map< uint64_t, std::vector< uint32_t > > cells;
+	//entries that would cover more than MaxCellsPerEntry cells:
+	std::vector< uint32_t > oversize;
+	enum : uint32_t { MaxCellsPerEntry = 64 };
+
+	glm::ivec3 cell_of(glm::vec3 const &pt) const;
+	static uint64_t key_of(glm::ivec3 const &cell);
+
+};
+
+//---------------------------
+
+template< typename F >
+void ColliderGrid::for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const {
+	auto check = [&](uint32_t id) {
+		Entry const &e = entries[id];
+		if (e.min.x > max.x || min.x > e.max.x
+		 || e.min.y > max.y || min.y > e.max.y
+		 || e.min.z > max.z || min.z > e.max.z) return;
+		fn(id);
+	};
+
+	for (uint32_t id : oversize) {
+		check(id);
+	}
+
+	glm::ivec3 c_min = cell_of(min);
+	glm::ivec3 c_max = cell_of(max);
+	glm::vec3 c_count = glm::vec3(c_max - c_min) + glm::vec3(1.0f);
+	if (c_count.x * c_count.y * c_count.z > float(cells.size())) {
+		//query box covers more cells than are occupied; just check everything:
+		for (uint32_t id = 0; id < entries.size(); ++id) {
+			if (entries[id].present && !entries[id].oversize) check(id);
+		}
+		return;
+	}
+	for (int32_t z = c_min.z; z <= c_max.z; ++z) {
+		for (int32_t y = c_min.y; y <= c_max.y; ++y) {
+			for (int32_t x = c_min.x; x <= c_max.x; ++x) {
+				auto f = cells.find(key_of(glm::ivec3(x,y,z)));
+				if (f == cells.end()) continue;
+				for (uint32_t id : f->second) {
+					//an entry is in every cell it covers; only report it from the first cell it shares with the query:
+					Entry const &e = entries[id];
+					if (x != std::max(c_min.x, e.cell_min.x)
+					 || y != std::max(c_min.y, e.cell_min.y)
+					 || z != std::max(c_min.z, e.cell_min.z)) continue;
+					check(id);
+				}
+			}
+		}
+	}
+}
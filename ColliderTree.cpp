@@ -0,0 +1,243 @@
+#include "ColliderTree.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+//(half) surface area of box; the usual cost of a node in a bounding volume hierarchy:
+static float area_of(glm::vec3 const &min, glm::vec3 const &max) {
+	glm::vec3 size = max - min;
+	return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+ColliderTree::ColliderTree(float margin_) : margin(margin_) {
+	assert(margin >= 0.0f);
+}
+
+uint32_t ColliderTree::allocate_node() {
+	if (!free_nodes.empty()) {
+		uint32_t node = free_nodes.back();
+		free_nodes.pop_back();
+		nodes[node] = Node();
+		return node;
+	}
+	nodes.emplace_back();
+	return uint32_t(nodes.size() - 1);
+}
+
+void ColliderTree::free_node(uint32_t node) {
+	assert(node < nodes.size());
+	free_nodes.emplace_back(node);
+}
+
+void ColliderTree::update(uint32_t id, glm::vec3 const &min, glm::vec3 const &max) {
+	if (id >= leaf_of.size()) {
+		leaf_of.resize(id + 1, -1U);
+	}
+
+	if (leaf_of[id] == -1U) {
+		uint32_t leaf = allocate_node();
+		Node &node = nodes[leaf];
+		node.id = id;
+		node.entry_min = min;
+		node.entry_max = max;
+		node.min = min - glm::vec3(margin);
+		node.max = max + glm::vec3(margin);
+		insert_leaf(leaf);
+		leaf_of[id] = leaf;
+		return;
+	}
+
+	uint32_t leaf = leaf_of[id];
+	Node &node = nodes[leaf];
+	node.entry_min = min;
+	node.entry_max = max;
+
+	//still inside grown box? then the tree doesn't change:
+	if (min.x >= node.min.x && min.y >= node.min.y && min.z >= node.min.z
+	 && max.x <= node.max.x && max.y <= node.max.y && max.z <= node.max.z) return;
+
+	glm::vec3 grown_min = min - glm::vec3(margin);
+	glm::vec3 grown_max = max + glm::vec3(margin);
+
+	if (grown_min.x > node.max.x || node.min.x > grown_max.x
+	 || grown_min.y > node.max.y || node.min.y > grown_max.y
+	 || grown_min.z > node.max.z || node.min.z > grown_max.z) {
+		//jumped somewhere else entirely; refitting would stretch every box above it, so re-insert instead:
+		remove_leaf(leaf);
+		nodes[leaf].min = grown_min;
+		nodes[leaf].max = grown_max;
+		insert_leaf(leaf);
+	} else {
+		//moved a bit; refit in place:
+		node.min = grown_min;
+		node.max = grown_max;
+		refit_from(node.parent);
+	}
+}
+
+void ColliderTree::remove(uint32_t id) {
+	if (id >= leaf_of.size() || leaf_of[id] == -1U) return;
+	uint32_t leaf = leaf_of[id];
+	remove_leaf(leaf);
+	free_node(leaf);
+	leaf_of[id] = -1U;
+}
+
+void ColliderTree::insert_leaf(uint32_t leaf) {
+	nodes[leaf].parent = -1U;
+	if (root == -1U) {
+		root = leaf;
+		return;
+	}
+
+	glm::vec3 leaf_min = nodes[leaf].min;
+	glm::vec3 leaf_max = nodes[leaf].max;
+
+	//walk down toward the cheapest sibling (surface area heuristic, as in Box2D's b2DynamicTree):
+	uint32_t sibling = root;
+	while (!nodes[sibling].is_leaf()) {
+		Node const &node = nodes[sibling];
+		float area = area_of(node.min, node.max);
+		float combined = area_of(glm::min(node.min, leaf_min), glm::max(node.max, leaf_max));
+
+		//cost of making a new parent for this node and the leaf:
+		float cost_here = 2.0f * combined;
+		//minimum cost pushed onto children by growing this node:
+		float inherited = 2.0f * (combined - area);
+
+		auto cost_of = [&](uint32_t child_index) {
+			Node const &child = nodes[child_index];
+			float grown = area_of(glm::min(child.min, leaf_min), glm::max(child.max, leaf_max));
+			if (child.is_leaf()) return grown + inherited;
+			return (grown - area_of(child.min, child.max)) + inherited;
+		};
+		float cost_left = cost_of(node.left);
+		float cost_right = cost_of(node.right);
+
+		if (cost_here < cost_left && cost_here < cost_right) break;
+		sibling = (cost_left < cost_right ? node.left : node.right);
+	}
+
+	//new parent for sibling and leaf:
+	uint32_t old_parent = nodes[sibling].parent;
+	uint32_t parent = allocate_node();
+	nodes[parent].parent = old_parent;
+	nodes[parent].left = sibling;
+	nodes[parent].right = leaf;
+	nodes[sibling].parent = parent;
+	nodes[leaf].parent = parent;
+
+	if (old_parent == -1U) {
+		root = parent;
+	} else if (nodes[old_parent].left == sibling) {
+		nodes[old_parent].left = parent;
+	} else {
+		nodes[old_parent].right = parent;
+	}
+
+	refit_from(parent);
+}
+
+void ColliderTree::remove_leaf(uint32_t leaf) {
+	if (leaf == root) {
+		root = -1U;
+		return;
+	}
+
+	uint32_t parent = nodes[leaf].parent;
+	uint32_t grandparent = nodes[parent].parent;
+	uint32_t sibling = (nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left);
+
+	//sibling takes parent's place:
+	nodes[sibling].parent = grandparent;
+	if (grandparent == -1U) {
+		root = sibling;
+	} else {
+		if (nodes[grandparent].left == parent) {
+			nodes[grandparent].left = sibling;
+		} else {
+			nodes[grandparent].right = sibling;
+		}
+	}
+	free_node(parent);
+	nodes[leaf].parent = -1U;
+
+	refit_from(grandparent);
+}
+
+void ColliderTree::refit_node(uint32_t index) {
+	Node &node = nodes[index];
+	assert(!node.is_leaf());
+	Node const &left = nodes[node.left];
+	Node const &right = nodes[node.right];
+	node.min = glm::min(left.min, right.min);
+	node.max = glm::max(left.max, right.max);
+	node.height = 1 + std::max(left.height, right.height);
+}
+
+void ColliderTree::refit_from(uint32_t index) {
+	while (index != -1U) {
+		refit_node(index);
+		rotate(index);
+		index = nodes[index].parent;
+	}
+}
+
+void ColliderTree::rotate(uint32_t index) {
+	//Try swapping one child of 'index' with a child of the other child
+	// ("tree rotations", as in Kopta et al. 2012, "Fast, Effective BVH Updates for Animated Scenes");
+	// the node's own box doesn't change, but the box of the child that receives the swapped node may shrink.
+	Node const &node = nodes[index];
+
+	uint32_t best_child = -1U; //child of 'index' to move down
+	uint32_t best_grandchild = -1U; //grandchild (under the other child) to move up
+	float best_saving = 0.0f;
+
+	auto consider = [&](uint32_t child, uint32_t other) {
+		Node const &o = nodes[other];
+		if (o.is_leaf()) return;
+		Node const &c = nodes[child];
+		float area = area_of(o.min, o.max);
+		//move o.left up (o then holds child + o.right), or o.right up (o then holds child + o.left):
+		Node const &ol = nodes[o.left];
+		Node const &orr = nodes[o.right];
+		float keep_right = area - area_of(glm::min(c.min, orr.min), glm::max(c.max, orr.max));
+		float keep_left = area - area_of(glm::min(c.min, ol.min), glm::max(c.max, ol.max));
+		if (keep_right > best_saving) {
+			best_saving = keep_right;
+			best_child = child;
+			best_grandchild = o.left;
+		}
+		if (keep_left > best_saving) {
+			best_saving = keep_left;
+			best_child = child;
+			best_grandchild = o.right;
+		}
+	};
+	consider(node.left, node.right);
+	consider(node.right, node.left);
+
+	if (best_child == -1U) return;
+
+	uint32_t other = nodes[best_grandchild].parent;
+	assert(nodes[other].parent == index);
+
+	//child takes grandchild's place under 'other':
+	if (nodes[other].left == best_grandchild) {
+		nodes[other].left = best_child;
+	} else {
+		nodes[other].right = best_child;
+	}
+	nodes[best_child].parent = other;
+
+	//grandchild takes child's place under 'index':
+	if (nodes[index].left == best_child) {
+		nodes[index].left = best_grandchild;
+	} else {
+		nodes[index].right = best_grandchild;
+	}
+	nodes[best_grandchild].parent = index;
+
+	refit_node(other);
+	refit_node(index);
+}
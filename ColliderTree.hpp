@@ -0,0 +1,105 @@
+#pragma once
+
+/*
+ * A ColliderTree is a broadphase structure that stores world-space
+ *  bounding boxes (identified by small integer ids) in a dynamic AABB tree.
+ *
+ * Leaves store their box grown by 'margin', so small moves don't change
+ *  the tree at all. When an entry moves out of its grown box, its leaf is
+ *  refit in place and the boxes above it are refit on the way to the root;
+ *  each node on that path is also offered a "tree rotation" (swapping a
+ *  child with a grandchild) if that makes its boxes smaller, so the tree
+ *  stays efficient as entries wander.
+ *
+ * So updating costs O(depth) per moved entry, independent of how many
+ *  entries there are.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+struct ColliderTree {
+	ColliderTree(float margin = 0.5f);
+
+	//add or move entry 'id' so it covers world-space box [min,max]:
+	void update(uint32_t id, glm::vec3 const &min, glm::vec3 const &max);
+
+	//remove entry 'id' (if present):
+	void remove(uint32_t id);
+
+	//call 'fn(uint32_t id)' exactly once for each entry whose box overlaps [min,max]:
+	// (queries don't modify the tree, so may run from several threads at once)
+	template< typename F >
+	void for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const;
+
+	//-- internals --
+
+	float margin;
+
+	struct Node {
+		glm::vec3 min = glm::vec3(0.0f); //(for leaves: the grown box)
+		glm::vec3 max = glm::vec3(0.0f);
+		uint32_t parent = -1U;
+		uint32_t left = -1U; //(-1U for leaves)
+		uint32_t right = -1U;
+		uint32_t height = 0; //(0 for leaves)
+		//leaves only:
+		uint32_t id = -1U;
+		glm::vec3 entry_min = glm::vec3(0.0f); //the entry's actual box
+		glm::vec3 entry_max = glm::vec3(0.0f);
+		bool is_leaf() const { return left == -1U; }
+	};
+	std::vector< Node > nodes;
+	std::vector< uint32_t > free_nodes;
+	uint32_t root = -1U;
+
+	//entry id -> leaf node index (or -1U if not present):
+	std::vector< uint32_t > leaf_of;
+
+	uint32_t allocate_node();
+	void free_node(uint32_t node);
+
+	//place (detached) leaf into the tree, next to the node where it adds the least surface area:
+	void insert_leaf(uint32_t leaf);
+	//take leaf out of the tree (its sibling replaces their parent):
+	void remove_leaf(uint32_t leaf);
+
+	//recompute boxes and heights from 'node' up to the root, rotating where it helps:
+	void refit_from(uint32_t node);
+	void rotate(uint32_t node);
+	void refit_node(uint32_t node);
+
+	template< typename F >
+	void for_each_overlapping_below(uint32_t node, glm::vec3 const &min, glm::vec3 const &max, F const &fn) const;
+};
+
+//---------------------------
+
+template< typename F >
+void ColliderTree::for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const {
+	if (root == -1U) return;
+	for_each_overlapping_below(root, min, max, fn);
+}
+
+template< typename F >
+void ColliderTree::for_each_overlapping_below(uint32_t index, glm::vec3 const &min, glm::vec3 const &max, F const &fn) const {
+	Node const &node = nodes[index];
+	if (node.min.x > max.x || min.x > node.max.x
+	 || node.min.y > max.y || min.y > node.max.y
+	 || node.min.z > max.z || min.z > node.max.z) return;
+
+	if (node.is_leaf()) {
+		//grown box overlaps; check the actual box:
+		if (node.entry_min.x > max.x || min.x > node.entry_max.x
+		 || node.entry_min.y > max.y || min.y > node.entry_max.y
+		 || node.entry_min.z > max.z || min.z > node.entry_max.z) return;
+		fn(node.id);
+		return;
+	}
+
+	for_each_overlapping_below(node.left, min, max, fn);
+	for_each_overlapping_below(node.right, min, max, fn);
+}
@@ -0,0 +1,128 @@
+#include "CollisionStats.hpp"
+#include "CollisionWorld.hpp"
+#include "DrawLines.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <stdexcept>
+
+CollisionStats::CollisionStats(CollisionWorld const &world) {
+	frame.resize(world.colliders.size());
+	total.resize(world.colliders.size());
+	heat.resize(world.colliders.size(), 0.0f);
+}
+
+CollisionStats::Counters &CollisionStats::Query::operator[](uint32_t collider) {
+	if (collider >= counts.size()) counts.resize(collider + 1);
+	Counters &c = counts[collider];
+	if (c.aabb_tests == 0 && c.triangle_tests == 0 && c.hits == 0) {
+		//(first count this query; every count is an increment, so one of these is about to become nonzero)
+		touched.emplace_back(collider);
+	}
+	return c;
+}
+
+void CollisionStats::Query::clear() {
+	for (uint32_t collider : touched) {
+		counts[collider] = Counters();
+	}
+	touched.clear();
+}
+
+void CollisionStats::add(Query const &query, double microseconds) {
+	uint64_t tests = 0;
+	for (uint32_t collider : query.touched) {
+		tests += query.counts[collider].aabb_tests + query.counts[collider].triangle_tests;
+	}
+
+	std::lock_guard< std::mutex > lock(frame_mutex);
+	if (tests == 0) {
+		frame_unattributed += microseconds;
+		return;
+	}
+	for (uint32_t collider : query.touched) {
+		Counters const &c = query.counts[collider];
+		if (collider >= frame.size()) continue; //(collider added after counting started)
+		Counters &f = frame[collider];
+		f.aabb_tests += c.aabb_tests;
+		f.triangle_tests += c.triangle_tests;
+		f.hits += c.hits;
+		f.microseconds += microseconds * double(c.aabb_tests + c.triangle_tests) / double(tests);
+	}
+}
+
+void CollisionStats::next_frame() {
+	std::lock_guard< std::mutex > lock(frame_mutex);
+	for (uint32_t i = 0; i < frame.size(); ++i) {
+		Counters &f = frame[i];
+		Counters &t = total[i];
+		t.aabb_tests += f.aabb_tests;
+		t.triangle_tests += f.triangle_tests;
+		t.hits += f.hits;
+		t.microseconds += f.microseconds;
+		//(roughly the last 10 frames)
+		heat[i] = glm::mix(heat[i], float(f.microseconds), 0.1f);
+		f = Counters();
+	}
+	total_unattributed += frame_unattributed;
+	frame_unattributed = 0.0;
+	frames += 1;
+}
+
+void CollisionStats::draw_heatmap(CollisionWorld const &world, DrawLines &lines) const {
+	float hottest = 0.0f;
+	for (float h : heat) {
+		hottest = std::max(hottest, h);
+	}
+	if (hottest <= 0.0f) return;
+
+	uint32_t count = uint32_t(std::min(heat.size(), world.colliders.size()));
+	for (uint32_t i = 0; i < count; ++i) {
+		float amt = heat[i] / hottest;
+		if (amt < 1e-3f) continue;
+		glm::vec3 cold = glm::vec3(0x00, 0x44, 0xff);
+		glm::vec3 hot = glm::vec3(0xff, 0x00, 0x00);
+		glm::u8vec4 color = glm::u8vec4(glm::mix(cold, hot, amt), 0xff);
+
+		CollisionWorld::Collider const &collider = world.colliders[i];
+		glm::vec3 const &min = collider.world_min;
+		glm::vec3 const &max = collider.world_max;
+		lines.draw_box(glm::mat4x3(
+			0.5f * (max.x - min.x), 0.0f, 0.0f,
+			0.0f, 0.5f * (max.y - min.y), 0.0f,
+			0.0f, 0.0f, 0.5f * (max.z - min.z),
+			0.5f * (max.x + min.x), 0.5f * (max.y + min.y), 0.5f * (max.z + min.z)
+		), color);
+	}
+}
+
+void CollisionStats::save_csv(CollisionWorld const &world, std::string const &filename) const {
+	std::ofstream file(filename);
+	double per_frame = (frames ? 1.0 / double(frames) : 0.0);
+
+	file << "collider,name,type,center_x,center_y,center_z,"
+		"aabb_tests,triangle_tests,hits,microseconds,"
+		"aabb_tests_per_frame,triangle_tests_per_frame,hits_per_frame,microseconds_per_frame\n";
+	uint32_t count = uint32_t(std::min(total.size(), world.colliders.size()));
+	for (uint32_t i = 0; i < count; ++i) {
+		CollisionWorld::Collider const &collider = world.colliders[i];
+		Counters const &t = total[i];
+		glm::vec3 center = 0.5f * (collider.world_min + collider.world_max);
+		//(names are quoted, with quotes doubled, in case they contain commas)
+		std::string name = collider.transform->name;
+		for (size_t at = name.find('"'); at != std::string::npos; at = name.find('"', at + 2)) {
+			name.insert(at, "\"");
+		}
+		file << i << ",\"" << name << "\","
+			<< (!collider.mesh ? "primitive" : (collider.baked ? "baked" : "moved")) << ","
+			<< center.x << "," << center.y << "," << center.z << ","
+			<< t.aabb_tests << "," << t.triangle_tests << "," << t.hits << "," << t.microseconds << ","
+			<< t.aabb_tests * per_frame << "," << t.triangle_tests * per_frame << ","
+			<< t.hits * per_frame << "," << t.microseconds * per_frame << "\n";
+	}
+	//time not split between colliders (e.g., spent in the distance field) goes in its own row:
+	file << "-1,\"(unattributed)\",none,0,0,0,0,0,0," << total_unattributed << ",0,0,0," << total_unattributed * per_frame << "\n";
+
+	if (!file) throw std::runtime_error("Failed to write collision stats to '" + filename + "'.");
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+ * CollisionStats counts, per collider, how much work a CollisionWorld's
+ *  queries spend on it -- to find which pieces (or regions) of a level
+ *  dominate collision time:
+ *  - aabb_tests: bounding box tests that reached the collider (hierarchy leaves, broadphase entries),
+ *  - triangle_tests: exact tests against its triangles (or its analytic shape),
+ *  - hits: times it was the surface a sweep or ray hit,
+ *  - microseconds: its share of the time spent in queries.
+ *
+ * Point CollisionWorld::stats at one to start counting.
+ * Each query counts privately and adds its counts when it finishes; its time
+ *  is split between the colliders it touched in proportion to their tests.
+ *  (time that can't be split -- e.g., sweeps through the distance field,
+ *   which doesn't know about colliders -- is kept as 'unattributed')
+ *
+ * Counts are kept for the current frame and summed over all frames; call
+ *  next_frame() once per update, when no queries are running.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct CollisionWorld;
+struct DrawLines;
+
+struct CollisionStats {
+	//start counting for the colliders in 'world':
+	CollisionStats(CollisionWorld const &world);
+
+	struct Counters {
+		uint64_t aabb_tests = 0;
+		uint64_t triangle_tests = 0;
+		uint64_t hits = 0;
+		double microseconds = 0.0;
+	};
+
+	//counts since the last next_frame() call, per collider:
+	std::vector< Counters > frame;
+	double frame_unattributed = 0.0; //microseconds
+	//counts summed over all finished frames, per collider:
+	std::vector< Counters > total;
+	double total_unattributed = 0.0;
+	uint32_t frames = 0;
+
+	//microseconds per frame, smoothed over recent frames (what the heatmap shows):
+	std::vector< float > heat;
+
+	//finish the current frame (adds it into 'total' and 'heat', then clears it):
+	void next_frame();
+
+	//draw each collider's bounds colored by its heat (blue is cheap, red is the most expensive collider):
+	// (colliders that cost nothing recently aren't drawn)
+	void draw_heatmap(CollisionWorld const &world, DrawLines &lines) const;
+
+	//write per-collider totals (and per-frame averages) as comma-separated values (throws on failure):
+	void save_csv(CollisionWorld const &world, std::string const &filename) const;
+
+	//counts made by one query (kept per-thread by CollisionWorld, so no locking while counting):
+	struct Query {
+		std::vector< Counters > counts; //indexed by collider
+		std::vector< uint32_t > touched; //colliders with counts this query
+		Counters &operator[](uint32_t collider);
+		void clear();
+	};
+
+	//add a finished query's counts and split its time (safe to call from several threads at once):
+	void add(Query const &query, double microseconds);
+
+	//-- internals --
+	std::mutex frame_mutex;
+};
@@ -0,0 +1,35 @@
+#include "CollisionTrace.hpp"
+#include "CollisionWorld.hpp"
+#include "read_write_chunk.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+CollisionTrace::CollisionTrace(CollisionWorld const &world) {
+	header.colliders = uint32_t(world.colliders.size());
+	header.baked_triangles = uint32_t(world.static_collision ? world.static_collision->triangles.size() : 0);
+}
+
+void CollisionTrace::record(Record const &record) {
+	std::lock_guard< std::mutex > lock(records_mutex);
+	records.emplace_back(record);
+}
+
+void CollisionTrace::save(std::string const &filename) const {
+	std::ofstream file(filename, std::ios::binary);
+	write_chunk("cth0", std::vector< Header >(1, header), &file);
+	write_chunk("ctr0", records, &file);
+	if (!file) throw std::runtime_error("Failed to write collision trace to '" + filename + "'.");
+}
+
+void CollisionTrace::load(std::string const &filename) {
+	std::ifstream file(filename, std::ios::binary);
+	if (!file) throw std::runtime_error("Failed to open collision trace '" + filename + "'.");
+
+	std::vector< Header > headers;
+	read_chunk(file, "cth0", &headers);
+	if (headers.size() != 1) throw std::runtime_error("Collision trace '" + filename + "' should have exactly one header.");
+	header = headers[0];
+
+	read_chunk(file, "ctr0", &records);
+}
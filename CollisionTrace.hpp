@@ -0,0 +1,78 @@
+#pragma once
+
+/*
+ * A CollisionTrace records the queries made of a CollisionWorld during play,
+ *  along with their results, so the same (realistic) workload can be saved
+ *  and replayed later -- see collision-replay.
+ *
+ * Point CollisionWorld::trace at one to start recording.
+ * Only queries made from outside the world are recorded (e.g., the sweeps
+ *  slide_sphere does on its own aren't recorded separately).
+ * Queries may still be made from several threads at once while recording.
+ *
+ * Traces are saved as chunks (see read_write_chunk.hpp) of fixed-size records.
+ */
+
+#include <glm/glm.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct CollisionWorld;
+
+struct CollisionTrace {
+	//empty trace (e.g., to load() into):
+	CollisionTrace() = default;
+	//empty trace, noting the shape of 'world' (so replays can check they're using the same level):
+	CollisionTrace(CollisionWorld const &world);
+
+	enum Kind : uint32_t {
+		SweepSphere = 0,
+		SweepSphereDistanceField = 1,
+		Raycast = 2,
+		RaycastAny = 3,
+		SlideSphere = 4, //(replayed with slide_sphere's default response)
+	};
+
+	struct Record {
+		uint32_t kind = SweepSphere;
+		uint32_t layers = 0;
+		//query:
+		// (for SlideSphere, 'from' is the starting position and 'to' the starting velocity)
+		glm::vec3 from = glm::vec3(0.0f);
+		glm::vec3 to = glm::vec3(0.0f);
+		float radius = 0.0f;
+		float elapsed = 0.0f; //(SlideSphere only)
+		uint32_t use_distance_field = 0; //(SlideSphere only) CollisionWorld::use_distance_field at the time
+		//result:
+		// (for SlideSphere, 'at' is the final position, 'out' the final velocity, and 'collided' is set if anything was hit)
+		uint32_t collided = 0;
+		float t = 1.0f;
+		glm::vec3 at = glm::vec3(0.0f);
+		glm::vec3 out = glm::vec3(0.0f);
+		uint32_t collider = -1U;
+	};
+	static_assert(sizeof(Record) == 4 + 4 + 4*3 + 4*3 + 4 + 4 + 4 + 4 + 4 + 4*3 + 4*3 + 4, "Record is packed.");
+
+	//shape of the level recorded on:
+	struct Header {
+		uint32_t colliders = 0;
+		uint32_t baked_triangles = 0;
+	};
+	static_assert(sizeof(Header) == 4 + 4, "Header is packed.");
+	Header header;
+
+	std::vector< Record > records;
+
+	//append a record (safe to call from several threads at once):
+	void record(Record const &record);
+
+	//write to / read from a file (throws on failure):
+	void save(std::string const &filename) const;
+	void load(std::string const &filename);
+
+	//-- internals --
+	std::mutex records_mutex;
+};
@@ -0,0 +1,1068 @@
+#include "CollisionWorld.hpp"
+
+#include "CollisionStats.hpp"
+#include "CollisionTrace.hpp"
+#include "DrawLines.hpp"
+#include "collide.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <limits>
+
+uint32_t CollisionWorld::add_mesh(Scene::Transform *transform, Mesh const &mesh, MeshData const &buffer, uint32_t layers) {
+	assert(transform);
+	assert(mesh.type == GL_TRIANGLES); //only have code for TRIANGLES not other primitive types
+	uint32_t id = uint32_t(colliders.size());
+	colliders.emplace_back(transform, mesh, buffer, layers);
+	update_cache(colliders.back());
+	//until bake() is called, collider is found through the broadphase:
+	moved_tree.update(id, colliders.back().world_min, colliders.back().world_max);
+	return id;
+}
+
+uint32_t CollisionWorld::add_primitive(Scene::Transform *transform, CollisionPrimitive const &primitive, uint32_t layers) {
+	assert(transform);
+	uint32_t id = uint32_t(colliders.size());
+	colliders.emplace_back(transform, primitive, layers);
+	update_cache(colliders.back());
+	//primitives are never baked, so always live in the broadphase:
+	moved_tree.update(id, colliders.back().world_min, colliders.back().world_max);
+	return id;
+}
+
+void CollisionWorld::bake() {
+	//bake colliders into world-space static geometry:
+	// (they are then no longer needed in the broadphase)
+	auto baked = std::make_shared< StaticCollision >();
+	for (uint32_t id = 0; id < colliders.size(); ++id) {
+		Collider &collider = colliders[id];
+		update_cache(collider);
+		collider.moved = false;
+		if (!collider.mesh) {
+			moved_tree.update(id, collider.world_min, collider.world_max);
+			continue;
+		}
+		baked->add(collider.to_world, *collider.mesh, *collider.buffer, id);
+		collider.baked = true;
+		moved_tree.remove(id);
+	}
+	baked->build();
+	static_collision = baked;
+	moved.clear();
+	shared_distance_field = std::make_shared< SharedDistanceField >();
+}
+
+void CollisionWorld::build_distance_field(float voxel_size, float band) {
+	start_distance_field(voxel_size, band);
+	if (shared_distance_field->building.valid()) shared_distance_field->building.wait();
+	finish_distance_field();
+}
+
+void CollisionWorld::start_distance_field(float voxel_size, float band) {
+	assert(static_collision && shared_distance_field && "call bake() before build_distance_field()");
+	if (shared_distance_field->field || shared_distance_field->building.valid()) return;
+	//(the build only reads the baked geometry, which never changes, so holds its own reference to it)
+	std::shared_ptr< StaticCollision const > geometry = static_collision;
+	shared_distance_field->building = std::async(std::launch::async, [geometry, voxel_size, band]() {
+		return std::shared_ptr< DistanceField const >(std::make_shared< DistanceField >(*geometry, voxel_size, band));
+	});
+}
+
+bool CollisionWorld::finish_distance_field() {
+	if (!shared_distance_field || !shared_distance_field->building.valid()) return false;
+	if (shared_distance_field->building.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+	shared_distance_field->field = shared_distance_field->building.get();
+	return true;
+}
+
+void CollisionWorld::collider_moved(uint32_t id) {
+	assert(id < colliders.size());
+	Collider &collider = colliders[id];
+	update_cache(collider);
+
+	//(listed once, so save() and restore() only look at colliders that have moved)
+	if (!collider.moved) moved.emplace_back(id);
+	collider.moved = true;
+
+	//collider's baked triangles (if any) are out of date, so test it through the broadphase instead:
+	if (collider.baked) moved_count += 1;
+	collider.baked = false;
+	moved_tree.update(id, collider.world_min, collider.world_max);
+}
+
+void CollisionWorld::save(Snapshot *snapshot) const {
+	assert(snapshot);
+	snapshot->moved.clear();
+	for (uint32_t id : moved) {
+		snapshot->moved.emplace_back(colliders[id]);
+	}
+	snapshot->moved_count = moved_count;
+}
+
+void CollisionWorld::restore(Snapshot const &snapshot) {
+	assert(snapshot.moved.size() <= moved.size());
+	//colliders that have moved since the snapshot go back to where their (restored) transforms put them:
+	for (uint32_t i = uint32_t(snapshot.moved.size()); i < moved.size(); ++i) {
+		uint32_t id = moved[i];
+		Collider &collider = colliders[id];
+		update_cache(collider);
+		collider.moved = false;
+		if (collider.mesh) {
+			//...which is where they were baked:
+			collider.baked = true;
+			moved_tree.remove(id);
+		} else {
+			moved_tree.update(id, collider.world_min, collider.world_max);
+		}
+	}
+	moved.resize(snapshot.moved.size());
+	//the rest are put back as they were:
+	for (uint32_t i = 0; i < moved.size(); ++i) {
+		Collider &collider = colliders[moved[i]];
+		collider = snapshot.moved[i];
+		moved_tree.update(moved[i], collider.world_min, collider.world_max);
+	}
+	moved_count = snapshot.moved_count;
+}
+
+void CollisionWorld::remap_transforms(std::unordered_map< Scene::Transform const *, Scene::Transform * > const &transform_to_transform) {
+	for (auto &c : colliders) {
+		c.transform = transform_to_transform.at(c.transform);
+	}
+}
+
+void CollisionWorld::update_cache(Collider &collider) {
+	//(the transform or one of its parents may have moved since it was last looked up this frame)
+	collider.transform->refresh_cache();
+	collider.to_world = collider.transform->make_local_to_world();
+	collider.to_local = collider.transform->make_world_to_local();
+
+	if (!collider.mesh) {
+		collider.world_primitive = collider.primitive.transformed(collider.to_world);
+		collider.world_primitive.bounds(&collider.world_min, &collider.world_max);
+		return;
+	}
+
+	//compute bounding box of collider in world space:
+	glm::vec3 local_center = 0.5f * (collider.mesh->max + collider.mesh->min);
+	glm::vec3 local_radius = 0.5f * (collider.mesh->max - collider.mesh->min);
+
+	glm::vec3 world_center = collider.to_world * glm::vec4(local_center, 1.0f);
+	glm::vec3 world_radius =
+		  glm::abs(local_radius.x * collider.to_world[0])
+		+ glm::abs(local_radius.y * collider.to_world[1])
+		+ glm::abs(local_radius.z * collider.to_world[2]);
+
+	collider.world_min = world_center - world_radius;
+	collider.world_max = world_center + world_radius;
+}
+
+//---------------------------
+//helpers:
+
+//transform world-space box [min,max] to (a box around it in) collider space:
+static void world_box_to_local(glm::mat4x3 const &to_local, glm::vec3 const &min, glm::vec3 const &max,
+	glm::vec3 *local_min, glm::vec3 *local_max) {
+	glm::vec3 center = 0.5f * (max + min);
+	glm::vec3 radius = 0.5f * (max - min);
+
+	glm::vec3 local_center = to_local * glm::vec4(center, 1.0f);
+	glm::vec3 local_radius =
+		  glm::abs(radius.x * to_local[0])
+		+ glm::abs(radius.y * to_local[1])
+		+ glm::abs(radius.z * to_local[2]);
+
+	*local_min = local_center - local_radius;
+	*local_max = local_center + local_radius;
+}
+
+//call fn(id, a, b, c) for every (world-space) triangle in 'layers' that the sphere swept from 'from' to 'to' might touch:
+template< typename F >
+static void for_each_triangle(CollisionWorld const &world, glm::vec3 const &from, glm::vec3 const &to, float radius,
+	uint32_t layers, F const &fn) {
+
+	//baked geometry of colliders that haven't moved:
+	if (world.static_collision) {
+		StaticCollision const &baked = *world.static_collision;
+		baked.for_each_candidate(from, to, radius, [&](uint32_t t) {
+			uint32_t id = baked.colliders[t];
+			CollisionWorld::Collider const &collider = world.colliders[id];
+			if (!collider.baked || !(collider.layers & layers)) return;
+			CollisionTriangle const &tri = baked.triangles[t];
+			fn(id, tri.a, tri.b, tri.c);
+		});
+	}
+
+	//colliders that have moved:
+	glm::vec3 min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 max = glm::max(from, to) + glm::vec3(radius);
+	world.moved_tree.for_each_overlapping(min, max, [&](uint32_t id) {
+		CollisionWorld::Collider const &collider = world.colliders[id];
+		if (!collider.mesh || !(collider.layers & layers)) return;
+		glm::vec3 local_min, local_max;
+		world_box_to_local(collider.to_local, min, max, &local_min, &local_max);
+		collider.mesh->bvh.for_each_overlapping(local_min, local_max, [&](uint32_t v) {
+			glm::vec3 a = collider.to_world * glm::vec4(collider.buffer->positions[v+0], 1.0f);
+			glm::vec3 b = collider.to_world * glm::vec4(collider.buffer->positions[v+1], 1.0f);
+			glm::vec3 c = collider.to_world * glm::vec4(collider.buffer->positions[v+2], 1.0f);
+			fn(id, a, b, c);
+		});
+	});
+}
+
+//call fn(id, primitive) for every (world-space) primitive collider in 'layers' whose bounds touch [min,max]:
+template< typename F >
+static void for_each_primitive(CollisionWorld const &world, glm::vec3 const &min, glm::vec3 const &max,
+	uint32_t layers, F const &fn) {
+	world.moved_tree.for_each_overlapping(min, max, [&](uint32_t id) {
+		CollisionWorld::Collider const &collider = world.colliders[id];
+		if (collider.mesh || !(collider.layers & layers)) return;
+		if (!collide_AABB_vs_AABB(min, max, collider.world_min, collider.world_max)) return;
+		fn(id, collider.world_primitive);
+	});
+}
+
+static void draw_triangle(DrawLines &lines, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c, glm::u8vec4 const &color) {
+	lines.draw(a,b,color);
+	lines.draw(b,c,color);
+	lines.draw(c,a,color);
+}
+
+static void draw_bounds(DrawLines &lines, glm::vec3 const &world_min, glm::vec3 const &world_max, glm::u8vec4 const &color) {
+	lines.draw_box(glm::mat4x3(
+		0.5f * (world_max.x - world_min.x), 0.0f, 0.0f,
+		0.0f, 0.5f * (world_max.y - world_min.y), 0.0f,
+		0.0f, 0.0f, 0.5f * (world_max.z - world_min.z),
+		0.5f * (world_max.x+world_min.x), 0.5f * (world_max.y+world_min.y), 0.5f * (world_max.z+world_min.z)
+	), color);
+}
+
+static void draw_primitive(DrawLines &lines, CollisionPrimitive const &primitive, glm::u8vec4 const &color) {
+	if (primitive.type == CollisionPrimitive::Box) {
+		lines.draw_box(glm::mat4x3(
+			primitive.half_size.x * primitive.axes[0],
+			primitive.half_size.y * primitive.axes[1],
+			primitive.half_size.z * primitive.axes[2],
+			primitive.a
+		), color);
+	} else {
+		glm::vec3 min, max;
+		primitive.bounds(&min, &max);
+		draw_bounds(lines, min, max, color);
+		lines.draw(primitive.a, primitive.b, color);
+	}
+}
+
+//draw bounds of all colliders in 'layers', highlighting those that overlap [min,max]:
+static void draw_collider_bounds(CollisionWorld const &world, DrawLines &lines, glm::vec3 const &min, glm::vec3 const &max, uint32_t layers) {
+	for (auto const &collider : world.colliders) {
+		if (!(collider.layers & layers)) continue;
+		bool can_skip = !collide_AABB_vs_AABB(min, max, collider.world_min, collider.world_max);
+		draw_bounds(lines, collider.world_min, collider.world_max,
+			(can_skip ? glm::u8vec4(0x88, 0x88, 0x88, 0xff) : glm::u8vec4(0x88, 0x88, 0x00, 0xff)) );
+	}
+}
+
+static void draw_hit_triangle(DrawLines &lines, CollisionWorld::DebugDraw const &debug, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+	if (!(debug.show_geometry || debug.show_collision)) return;
+	glm::u8vec4 color = glm::u8vec4(0x88, 0x00, 0x00, 0xff);
+	draw_triangle(lines, a, b, c, color);
+	//do a bit more to highlight colliding triangle (otherwise edges can be over-drawn by non-colliding triangles):
+	if (debug.show_collision) {
+		glm::vec3 m = (a + b + c) / 3.0f;
+		draw_triangle(lines, glm::mix(a,m,0.1f), glm::mix(b,m,0.1f), glm::mix(c,m,0.1f), color);
+	}
+}
+
+//draw a little gadget at a collision point:
+static void draw_contact(DrawLines &lines, glm::vec3 const &collision_at, glm::vec3 const &collision_out) {
+	glm::vec3 p1;
+	if (std::abs(collision_out.x) <= std::abs(collision_out.y) && std::abs(collision_out.x) <= std::abs(collision_out.z)) {
+		p1 = glm::vec3(1.0f, 0.0f, 0.0f);
+	} else if (std::abs(collision_out.y) <= std::abs(collision_out.z)) {
+		p1 = glm::vec3(0.0f, 1.0f, 0.0f);
+	} else {
+		p1 = glm::vec3(0.0f, 0.0f, 1.0f);
+	}
+	p1 = glm::normalize(p1 - glm::dot(p1, collision_out)*collision_out);
+	glm::vec3 p2 = glm::cross(collision_out, p1);
+
+	float r = 0.25f;
+	glm::u8vec4 color = glm::u8vec4(0xff, 0x00, 0x00, 0xff);
+	lines.draw(collision_at + r*p1, collision_at + r*p2, color);
+	lines.draw(collision_at + r*p2, collision_at - r*p1, color);
+	lines.draw(collision_at - r*p1, collision_at - r*p2, color);
+	lines.draw(collision_at - r*p2, collision_at + r*p1, color);
+	lines.draw(collision_at, collision_at + collision_out, color);
+}
+
+//---------------------------
+//queries:
+
+//Queries running on this thread; only the outermost is traced, so (e.g.) the sweeps slide_sphere makes aren't recorded on their own:
+static thread_local uint32_t query_depth = 0;
+//...and, if the world has stats, what they've tested (nested queries count into the outermost one):
+static thread_local CollisionStats::Query query_counts;
+struct QueryScope {
+	QueryScope(CollisionWorld const &world) : stats(world.stats) {
+		query_depth += 1;
+		if (stats && query_depth == 1) {
+			query_counts.clear();
+			start = std::chrono::high_resolution_clock::now();
+		}
+	}
+	~QueryScope() {
+		if (stats && query_depth == 1) {
+			auto end = std::chrono::high_resolution_clock::now();
+			stats->add(query_counts, std::chrono::duration< double, std::micro >(end - start).count());
+		}
+		query_depth -= 1;
+	}
+	bool outermost() const { return query_depth == 1; }
+	CollisionStats *stats;
+	std::chrono::high_resolution_clock::time_point start;
+};
+
+//per-collider counts for the running query (or nullptr if the world isn't counting):
+static CollisionStats::Query *counting(CollisionWorld const &world) {
+	return (world.stats && query_depth != 0 ? &query_counts : nullptr);
+}
+
+static void trace_query(CollisionTrace *trace, uint32_t kind, glm::vec3 const &from, glm::vec3 const &to, float radius,
+	uint32_t layers, bool collided, CollisionWorld::Hit const &hit) {
+	CollisionTrace::Record record;
+	record.kind = kind;
+	record.layers = layers;
+	record.from = from;
+	record.to = to;
+	record.radius = radius;
+	record.collided = collided;
+	if (collided) {
+		record.t = hit.t;
+		record.at = hit.at;
+		record.out = hit.out;
+		record.collider = hit.collider;
+	}
+	trace->record(record);
+}
+
+bool CollisionWorld::sweep_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit_,
+	uint32_t layers, DebugDraw const *debug) const {
+	QueryScope scope(*this);
+	CollisionStats::Query *counts = counting(*this);
+
+	Hit hit;
+	bool collided = false;
+
+	glm::vec3 sweep_min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 sweep_max = glm::max(from, to) + glm::vec3(radius);
+
+	DrawLines *lines = (debug ? debug->lines : nullptr);
+	bool show_geometry = lines && debug->show_geometry;
+	glm::u8vec4 const tested_color = glm::u8vec4(0x88, 0x88, 0x00, 0xff);
+	glm::vec3 hit_a, hit_b, hit_c; //triangle that was hit (for debug drawing)
+
+	//draw bounds of all colliders to indicate which overlap the swept sphere (DEBUG):
+	if (show_geometry) draw_collider_bounds(*this, *lines, sweep_min, sweep_max, layers);
+
+	//Baked (world-space) geometry of colliders that haven't moved, using precomputed triangle records:
+	if (static_collision) {
+		StaticCollision const &baked = *static_collision;
+		baked.for_each_candidate(from, to, radius, [&](uint32_t t) {
+			uint32_t id = baked.colliders[t];
+			Collider const &collider = colliders[id];
+			if (!collider.baked || !(collider.layers & layers)) return; //collider moved (handled below) or not asked for
+			CollisionTriangle const &tri = baked.triangles[t];
+			if (counts) {
+				(*counts)[id].aabb_tests += 1;
+				(*counts)[id].triangle_tests += 1;
+			}
+			if (collide_swept_sphere_vs_triangle(from, to, radius, tri, &hit.t, &hit.at, &hit.out)) {
+				collided = true;
+				hit.collider = id;
+				hit_a = tri.a; hit_b = tri.b; hit_c = tri.c;
+			}
+			if (show_geometry) draw_triangle(*lines, tri.a, tri.b, tri.c, tested_color);
+		});
+	}
+
+	//Colliders that have moved:
+	// broadphase only reports colliders whose (cached) world bounds overlap the swept sphere's bounds;
+	// candidate triangles from each collider's hierarchy are tested in blocks.
+	TriangleBlock block;
+	moved_tree.for_each_overlapping(sweep_min, sweep_max, [&](uint32_t id) {
+		Collider const &collider = colliders[id];
+		if (!(collider.layers & layers)) return;
+		if (counts) (*counts)[id].aabb_tests += 1;
+
+		if (!collider.mesh) {
+			if (counts) (*counts)[id].triangle_tests += 1;
+			if (show_geometry) draw_primitive(*lines, collider.world_primitive, tested_color);
+			if (collide_swept_sphere_vs_primitive(from, to, radius, collider.world_primitive, &hit.t, &hit.at, &hit.out)) {
+				collided = true;
+				hit.collider = id;
+				hit_a = hit_b = hit_c = hit.at;
+			}
+			return;
+		}
+
+		auto flush = [&]() {
+			if (counts) (*counts)[id].triangle_tests += block.count;
+			uint32_t lane = collide_swept_sphere_vs_triangles(from, to, radius, block, &hit.t, &hit.at, &hit.out);
+			if (lane != -1U) {
+				collided = true;
+				hit.collider = id;
+				hit_a = block.a(lane); hit_b = block.b(lane); hit_c = block.c(lane);
+			}
+			block.count = 0;
+		};
+
+		glm::vec3 local_min, local_max;
+		world_box_to_local(collider.to_local, sweep_min, sweep_max, &local_min, &local_max);
+		collider.mesh->bvh.for_each_overlapping(local_min, local_max, [&](uint32_t v) {
+			glm::vec3 a = collider.to_world * glm::vec4(collider.buffer->positions[v+0], 1.0f);
+			glm::vec3 b = collider.to_world * glm::vec4(collider.buffer->positions[v+1], 1.0f);
+			glm::vec3 c = collider.to_world * glm::vec4(collider.buffer->positions[v+2], 1.0f);
+			if (show_geometry) draw_triangle(*lines, a, b, c, tested_color);
+			block.push(a, b, c);
+			if (block.count == TriangleBlock::Width) flush();
+		});
+		if (block.count != 0) flush();
+	});
+
+	if (collided && lines) draw_hit_triangle(*lines, *debug, hit_a, hit_b, hit_c);
+	if (collided && counts) (*counts)[hit.collider].hits += 1;
+
+	if (trace && scope.outermost()) trace_query(trace, CollisionTrace::SweepSphere, from, to, radius, layers, collided, hit);
+
+	if (collided && hit_) *hit_ = hit;
+	return collided;
+}
+
+void CollisionWorld::sweep_spheres(std::vector< SphereCast > *casts_, uint32_t layers) const {
+	QueryScope scope(*this);
+	assert(casts_);
+	std::vector< SphereCast > &casts = *casts_;
+
+	for (auto &cast : casts) {
+		cast.hit = Hit();
+		cast.collided = sweep_sphere(cast.from, cast.to, cast.radius, &cast.hit, layers);
+	}
+
+	//(traced as if each sweep had been made on its own)
+	if (trace && scope.outermost()) {
+		for (auto const &cast : casts) {
+			trace_query(trace, CollisionTrace::SweepSphere, cast.from, cast.to, cast.radius, layers, cast.collided, cast.hit);
+		}
+	}
+}
+
+bool CollisionWorld::sweep_sphere_distance_field(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit_,
+	uint32_t layers, DebugDraw const *debug) const {
+	QueryScope scope(*this);
+
+	Hit hit;
+	bool collided = false;
+
+	//field only knows about geometry as baked (and may give up partway along long, grazing sweeps):
+	DistanceField const *field = distance_field();
+	bool exact = (!field || moved_count != 0 || radius > field->max_radius());
+	if (!exact) {
+		collided = field->sweep_sphere(from, to, radius, &hit.t, &hit.at, &hit.out, &exact);
+	}
+	if (exact) {
+		collided = sweep_sphere(from, to, radius, &hit, layers, debug);
+		if (trace && scope.outermost()) trace_query(trace, CollisionTrace::SweepSphereDistanceField, from, to, radius, layers, collided, hit);
+		if (collided && hit_) *hit_ = hit;
+		return collided;
+	}
+
+	//primitive colliders aren't part of the field:
+	CollisionStats::Query *counts = counting(*this);
+	glm::vec3 sweep_min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 sweep_max = glm::max(from, to) + glm::vec3(radius);
+	for_each_primitive(*this, sweep_min, sweep_max, layers, [&](uint32_t id, CollisionPrimitive const &primitive) {
+		if (counts) {
+			(*counts)[id].aabb_tests += 1;
+			(*counts)[id].triangle_tests += 1;
+		}
+		if (collide_swept_sphere_vs_primitive(from, to, radius, primitive, &hit.t, &hit.at, &hit.out)) {
+			collided = true;
+			hit.collider = id;
+		}
+	});
+
+	//(hits on the field itself don't know which collider they belong to)
+	if (collided && counts && hit.collider != -1U) (*counts)[hit.collider].hits += 1;
+
+	if (trace && scope.outermost()) trace_query(trace, CollisionTrace::SweepSphereDistanceField, from, to, radius, layers, collided, hit);
+
+	if (collided && hit_) *hit_ = hit;
+	return collided;
+}
+
+//find first hit of segment (or, if 'any' is set, stop at the first hit found):
+static bool trace_segment(CollisionWorld const &world, glm::vec3 const &from, glm::vec3 const &to,
+	uint32_t layers, bool any, CollisionWorld::Hit *hit_) {
+
+	CollisionStats::Query *counts = counting(world);
+	CollisionWorld::Hit hit;
+	bool collided = false;
+	glm::vec3 dir = to - from;
+
+	//Baked geometry, using precomputed triangle records:
+	// (ray tests lower hit.t, which also prunes the hierarchy walk)
+	if (world.static_collision) {
+		StaticCollision const &baked = *world.static_collision;
+		baked.for_each_along_segment(from, to, &hit.t, [&](uint32_t t) -> bool {
+			uint32_t id = baked.colliders[t];
+			CollisionWorld::Collider const &collider = world.colliders[id];
+			if (!collider.baked || !(collider.layers & layers)) return true;
+			if (counts) {
+				(*counts)[id].aabb_tests += 1;
+				(*counts)[id].triangle_tests += 1;
+			}
+			if (collide_ray_vs_triangle(from, dir, baked.triangles[t], &hit.t, &hit.out)) {
+				collided = true;
+				hit.collider = id;
+				if (any) return false;
+			}
+			return true;
+		});
+		if (collided && any) {
+			if (counts) (*counts)[hit.collider].hits += 1;
+			if (hit_) *hit_ = hit;
+			return true;
+		}
+	}
+
+	//Colliders that have moved:
+	// segment is transformed to collider space (which doesn't change its parameterization) and traced there.
+	glm::vec3 min = glm::min(from, to);
+	glm::vec3 max = glm::max(from, to);
+	world.moved_tree.for_each_overlapping(min, max, [&](uint32_t id) {
+		if (collided && any) return;
+		CollisionWorld::Collider const &collider = world.colliders[id];
+		if (!(collider.layers & layers)) return;
+		if (counts) (*counts)[id].aabb_tests += 1;
+
+		if (!collider.mesh) {
+			//a segment is a sweep of a zero-radius sphere:
+			if (counts) (*counts)[id].triangle_tests += 1;
+			if (collide_swept_sphere_vs_primitive(from, to, 0.0f, collider.world_primitive, &hit.t, nullptr, &hit.out)) {
+				collided = true;
+				hit.collider = id;
+			}
+			return;
+		}
+
+		glm::vec3 local_from = collider.to_local * glm::vec4(from, 1.0f);
+		glm::vec3 local_to = collider.to_local * glm::vec4(to, 1.0f);
+		glm::vec3 local_dir = local_to - local_from;
+		std::vector< glm::vec3 > const &positions = collider.buffer->positions;
+
+		collider.mesh->bvh.for_each_along_segment(local_from, local_to, &hit.t, [&](uint32_t v) -> bool {
+			glm::vec3 local_out;
+			if (counts) (*counts)[id].triangle_tests += 1;
+			if (collide_ray_vs_triangle(local_from, local_dir, positions[v+0], positions[v+1], positions[v+2], &hit.t, &local_out)) {
+				collided = true;
+				hit.collider = id;
+				//normals transform by the inverse transpose:
+				hit.out = glm::normalize(glm::transpose(glm::mat3(collider.to_local)) * local_out);
+				if (any) return false;
+			}
+			return true;
+		});
+	});
+
+	if (collided) {
+		hit.at = from + hit.t * dir;
+		if (counts) (*counts)[hit.collider].hits += 1;
+		if (hit_) *hit_ = hit;
+	}
+	return collided;
+}
+
+bool CollisionWorld::raycast(glm::vec3 const &from, glm::vec3 const &to, Hit *hit_, uint32_t layers) const {
+	QueryScope scope(*this);
+	Hit hit;
+	bool collided = trace_segment(*this, from, to, layers, false, &hit);
+	if (trace && scope.outermost()) trace_query(trace, CollisionTrace::Raycast, from, to, 0.0f, layers, collided, hit);
+	if (collided && hit_) *hit_ = hit;
+	return collided;
+}
+
+bool CollisionWorld::raycast_any(glm::vec3 const &from, glm::vec3 const &to, uint32_t layers) const {
+	QueryScope scope(*this);
+	bool collided = trace_segment(*this, from, to, layers, true, nullptr);
+	//(which hit was found first isn't part of the result, so isn't recorded)
+	if (trace && scope.outermost()) trace_query(trace, CollisionTrace::RaycastAny, from, to, 0.0f, layers, collided, Hit());
+	return collided;
+}
+
+//Scratch space for overlap queries, reused from call to call (per thread, since queries may run on several at once):
+struct OverlapScratch {
+	//reported[id] == stamp for colliders the running query has already found:
+	std::vector< uint32_t > reported;
+	uint32_t stamp = 0;
+	//colliders found, per query depth (so a query made from 'fn' doesn't clobber the list being reported):
+	// (a deque, so growing it for deeper queries doesn't move the lists already in use)
+	std::deque< std::vector< uint32_t > > found;
+};
+static thread_local OverlapScratch overlap_scratch;
+
+//start an overlap query (inside its QueryScope); returns the (empty) list to put colliders it finds in:
+static std::vector< uint32_t > &begin_overlap(CollisionWorld const &world) {
+	OverlapScratch &scratch = overlap_scratch;
+	if (scratch.reported.size() < world.colliders.size()) scratch.reported.resize(world.colliders.size(), 0);
+	scratch.stamp += 1;
+	if (scratch.stamp == 0) {
+		//stamp wrapped around, so old marks might match it:
+		std::fill(scratch.reported.begin(), scratch.reported.end(), 0);
+		scratch.stamp = 1;
+	}
+	assert(query_depth != 0);
+	if (scratch.found.size() < query_depth) scratch.found.resize(query_depth);
+	std::vector< uint32_t > &found = scratch.found[query_depth - 1];
+	found.clear();
+	return found;
+}
+
+void CollisionWorld::overlap_sphere_fn(glm::vec3 const &center, float radius, OverlapFn const &fn, uint32_t layers) const {
+	QueryScope scope(*this);
+	CollisionStats::Query *counts = counting(*this);
+	std::vector< uint32_t > &found = begin_overlap(*this);
+	std::vector< uint32_t > &reported = overlap_scratch.reported;
+	uint32_t stamp = overlap_scratch.stamp;
+	for_each_triangle(*this, center, center, radius, layers, [&](uint32_t id, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+		if (reported[id] == stamp) return;
+		if (counts) (*counts)[id].triangle_tests += 1;
+		if (collide_sphere_vs_triangle(center, radius, a, b, c)) {
+			reported[id] = stamp;
+			found.emplace_back(id);
+		}
+	});
+	for_each_primitive(*this, center - glm::vec3(radius), center + glm::vec3(radius), layers, [&](uint32_t id, CollisionPrimitive const &primitive) {
+		if (counts) (*counts)[id].triangle_tests += 1;
+		if (collide_sphere_vs_primitive(center, radius, primitive)) found.emplace_back(id);
+	});
+	for (uint32_t id : found) {
+		fn(id);
+	}
+}
+
+void CollisionWorld::overlap_swept_sphere_fn(glm::vec3 const &from, glm::vec3 const &to, float radius, OverlapFn const &fn, uint32_t layers) const {
+	QueryScope scope(*this);
+	CollisionStats::Query *counts = counting(*this);
+	std::vector< uint32_t > &found = begin_overlap(*this);
+	std::vector< uint32_t > &reported = overlap_scratch.reported;
+	uint32_t stamp = overlap_scratch.stamp;
+	for_each_triangle(*this, from, to, radius, layers, [&](uint32_t id, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+		if (reported[id] == stamp) return;
+		if (counts) (*counts)[id].triangle_tests += 1;
+		//sphere may start out touching the triangle (which the swept test doesn't count):
+		float t = 1.0f;
+		if (collide_sphere_vs_triangle(from, radius, a, b, c)
+		 || collide_swept_sphere_vs_triangle(from, to, radius, a, b, c, &t)) {
+			reported[id] = stamp;
+			found.emplace_back(id);
+		}
+	});
+	glm::vec3 min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 max = glm::max(from, to) + glm::vec3(radius);
+	for_each_primitive(*this, min, max, layers, [&](uint32_t id, CollisionPrimitive const &primitive) {
+		if (counts) (*counts)[id].triangle_tests += 1;
+		float t = 1.0f;
+		if (collide_sphere_vs_primitive(from, radius, primitive)
+		 || collide_swept_sphere_vs_primitive(from, to, radius, primitive, &t)) {
+			found.emplace_back(id);
+		}
+	});
+	for (uint32_t id : found) {
+		fn(id);
+	}
+}
+
+void CollisionWorld::gather_candidates(glm::vec3 const &min, glm::vec3 const &max, uint32_t layers, SlideCache *cache) const {
+	assert(cache);
+	cache->min = min;
+	cache->max = max;
+	cache->baked.clear();
+	cache->moved.clear();
+	cache->primitives.clear();
+	cache->gathers += 1;
+	CollisionStats::Query *counts = counting(*this);
+
+	//baked geometry of colliders that haven't moved:
+	if (static_collision) {
+		StaticCollision const &baked = *static_collision;
+		baked.bvh.for_each_overlapping(min, max, [&](uint32_t v) {
+			uint32_t t = v / 3;
+			Collider const &collider = colliders[baked.colliders[t]];
+			if (!collider.baked || !(collider.layers & layers)) return;
+			if (counts) (*counts)[baked.colliders[t]].aabb_tests += 1;
+			cache->baked.emplace_back(t);
+		});
+	}
+
+	//colliders that have moved:
+	moved_tree.for_each_overlapping(min, max, [&](uint32_t id) {
+		Collider const &collider = colliders[id];
+		if (!(collider.layers & layers)) return;
+		if (counts) (*counts)[id].aabb_tests += 1;
+		if (!collider.mesh) {
+			cache->primitives.emplace_back(id);
+			return;
+		}
+		glm::vec3 local_min, local_max;
+		world_box_to_local(collider.to_local, min, max, &local_min, &local_max);
+		collider.mesh->bvh.for_each_overlapping(local_min, local_max, [&](uint32_t v) {
+			if (counts) (*counts)[id].aabb_tests += 1;
+			SlideCache::MovedTriangle tri;
+			tri.a = collider.to_world * glm::vec4(collider.buffer->positions[v+0], 1.0f);
+			tri.b = collider.to_world * glm::vec4(collider.buffer->positions[v+1], 1.0f);
+			tri.c = collider.to_world * glm::vec4(collider.buffer->positions[v+2], 1.0f);
+			tri.collider = id;
+			tri.vertex = v;
+			cache->moved.emplace_back(tri);
+		});
+	});
+
+	//triangles hit last time are likely to be hit again, so test them first:
+	// (an early hit lowers the sweep's t, which lets the exact test reject later triangles sooner)
+	if (!cache->baked_contacts.empty()) {
+		std::stable_partition(cache->baked.begin(), cache->baked.end(), [&](uint32_t t) {
+			return std::find(cache->baked_contacts.begin(), cache->baked_contacts.end(), t) != cache->baked_contacts.end();
+		});
+	}
+	if (!cache->moved_contacts.empty()) {
+		std::stable_partition(cache->moved.begin(), cache->moved.end(), [&](SlideCache::MovedTriangle const &tri) {
+			return std::find(cache->moved_contacts.begin(), cache->moved_contacts.end(), std::make_pair(tri.collider, tri.vertex)) != cache->moved_contacts.end();
+		});
+	}
+	cache->baked_contacts.clear();
+	cache->moved_contacts.clear();
+}
+
+bool CollisionWorld::sweep_sphere_cached(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit_,
+	SlideCache *cache, DebugDraw const *debug) const {
+	assert(cache);
+	CollisionStats::Query *counts = counting(*this);
+
+	Hit hit;
+	bool collided = false;
+
+	glm::vec3 sweep_min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 sweep_max = glm::max(from, to) + glm::vec3(radius);
+
+	DrawLines *lines = (debug ? debug->lines : nullptr);
+	bool show_geometry = lines && debug->show_geometry;
+	glm::u8vec4 const tested_color = glm::u8vec4(0x88, 0x88, 0x00, 0xff);
+	glm::vec3 hit_a, hit_b, hit_c; //triangle that was hit (for debug drawing)
+
+	//which candidate was hit (for recording contacts):
+	bool hit_baked = false;
+	uint32_t hit_index = -1U;
+
+	//Baked candidates:
+	// plane test is padded slightly so it never rejects a triangle the exact test would accept
+	float const limit = radius + 1e-3f;
+	if (!cache->baked.empty()) {
+		StaticCollision const &baked = *static_collision;
+		for (uint32_t t : cache->baked) {
+			CollisionTriangle const &tri = baked.triangles[t];
+			glm::vec3 tri_min = glm::min(glm::min(tri.a, tri.b), tri.c);
+			glm::vec3 tri_max = glm::max(glm::max(tri.a, tri.b), tri.c);
+			float d_from = glm::dot(tri.normal, from) - tri.offset;
+			float d_to = glm::dot(tri.normal, to) - tri.offset;
+			if (counts) (*counts)[baked.colliders[t]].aabb_tests += 1;
+			if (!collide_AABB_vs_AABB(sweep_min, sweep_max, tri_min, tri_max)
+			 || (d_from > limit && d_to > limit) || (d_from < -limit && d_to < -limit)) {
+				cache->triangles_skipped += 1;
+				continue;
+			}
+			cache->triangle_tests += 1;
+			if (counts) (*counts)[baked.colliders[t]].triangle_tests += 1;
+			if (collide_swept_sphere_vs_triangle(from, to, radius, tri, &hit.t, &hit.at, &hit.out)) {
+				collided = true;
+				hit.collider = baked.colliders[t];
+				hit_baked = true;
+				hit_index = t;
+				hit_a = tri.a; hit_b = tri.b; hit_c = tri.c;
+			}
+			if (show_geometry) draw_triangle(*lines, tri.a, tri.b, tri.c, tested_color);
+		}
+	}
+
+	//Moved candidates, tested in blocks:
+	TriangleBlock block;
+	uint32_t block_index[TriangleBlock::Width];
+	auto flush = [&]() {
+		cache->triangle_tests += block.count;
+		if (counts) {
+			for (uint32_t lane = 0; lane < block.count; ++lane) {
+				(*counts)[cache->moved[block_index[lane]].collider].triangle_tests += 1;
+			}
+		}
+		uint32_t lane = collide_swept_sphere_vs_triangles(from, to, radius, block, &hit.t, &hit.at, &hit.out);
+		if (lane != -1U) {
+			collided = true;
+			hit.collider = cache->moved[block_index[lane]].collider;
+			hit_baked = false;
+			hit_index = block_index[lane];
+			hit_a = block.a(lane); hit_b = block.b(lane); hit_c = block.c(lane);
+		}
+		block.count = 0;
+	};
+	for (uint32_t i = 0; i < cache->moved.size(); ++i) {
+		SlideCache::MovedTriangle const &tri = cache->moved[i];
+		glm::vec3 tri_min = glm::min(glm::min(tri.a, tri.b), tri.c);
+		glm::vec3 tri_max = glm::max(glm::max(tri.a, tri.b), tri.c);
+		if (counts) (*counts)[tri.collider].aabb_tests += 1;
+		if (!collide_AABB_vs_AABB(sweep_min, sweep_max, tri_min, tri_max)) {
+			cache->triangles_skipped += 1;
+			continue;
+		}
+		if (show_geometry) draw_triangle(*lines, tri.a, tri.b, tri.c, tested_color);
+		block_index[block.count] = i;
+		block.push(tri.a, tri.b, tri.c);
+		if (block.count == TriangleBlock::Width) flush();
+	}
+	if (block.count != 0) flush();
+
+	//Primitive candidates:
+	bool hit_primitive = false;
+	for (uint32_t id : cache->primitives) {
+		Collider const &collider = colliders[id];
+		if (counts) (*counts)[id].aabb_tests += 1;
+		if (!collide_AABB_vs_AABB(sweep_min, sweep_max, collider.world_min, collider.world_max)) {
+			cache->triangles_skipped += 1;
+			continue;
+		}
+		cache->triangle_tests += 1;
+		if (counts) (*counts)[id].triangle_tests += 1;
+		if (show_geometry) draw_primitive(*lines, collider.world_primitive, tested_color);
+		if (collide_swept_sphere_vs_primitive(from, to, radius, collider.world_primitive, &hit.t, &hit.at, &hit.out)) {
+			collided = true;
+			hit.collider = id;
+			hit_primitive = true;
+			hit_baked = false;
+			hit_a = hit_b = hit_c = hit.at;
+		}
+	}
+
+	if (collided) {
+		if (counts) (*counts)[hit.collider].hits += 1;
+		//(primitive hits aren't recorded: each primitive is a single test, so there is little to gain by reordering)
+		if (hit_baked) {
+			cache->baked_contacts.emplace_back(hit_index);
+		} else if (!hit_primitive) {
+			cache->moved_contacts.emplace_back(cache->moved[hit_index].collider, cache->moved[hit_index].vertex);
+		}
+		if (lines) draw_hit_triangle(*lines, *debug, hit_a, hit_b, hit_c);
+		if (hit_) *hit_ = hit;
+	}
+	return collided;
+}
+
+void CollisionWorld::Manifold::add(Hit const &hit) {
+	for (uint32_t i = 0; i < count; ++i) {
+		//(e.g., both triangles of a flat seam)
+		if (glm::dot(contacts[i].out, hit.out) > 0.999f) return;
+	}
+	if (count < MaxContacts) contacts[count++] = hit;
+}
+
+void CollisionWorld::gather_contacts(glm::vec3 const &center, float radius, float skin, Manifold *manifold,
+	uint32_t layers, SlideCache const *cache) const {
+	QueryScope scope(*this);
+	CollisionStats::Query *counts = counting(*this);
+	assert(manifold);
+	float const reach = radius + skin;
+
+	auto add = [&](uint32_t id, glm::vec3 const &closest) {
+		glm::vec3 to_center = center - closest;
+		float length2 = glm::dot(to_center, to_center);
+		if (length2 > reach * reach || length2 == 0.0f) return;
+		Hit hit;
+		hit.t = 0.0f;
+		hit.at = closest;
+		hit.out = to_center / std::sqrt(length2);
+		hit.collider = id;
+		manifold->add(hit);
+	};
+	auto add_triangle = [&](uint32_t id, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+		if (counts) (*counts)[id].triangle_tests += 1;
+		add(id, closest_point_on_triangle(center, a, b, c));
+	};
+	auto add_primitive = [&](uint32_t id, CollisionPrimitive const &primitive) {
+		if (counts) (*counts)[id].triangle_tests += 1;
+		glm::vec3 closest;
+		if (collide_sphere_vs_primitive(center, reach, primitive, &closest)) add(id, closest);
+	};
+
+	if (!cache) {
+		for_each_triangle(*this, center, center, reach, layers, add_triangle);
+		for_each_primitive(*this, center - glm::vec3(reach), center + glm::vec3(reach), layers, add_primitive);
+		return;
+	}
+
+	assert(center.x - reach >= cache->min.x && center.y - reach >= cache->min.y && center.z - reach >= cache->min.z
+	    && center.x + reach <= cache->max.x && center.y + reach <= cache->max.y && center.z + reach <= cache->max.z);
+	for (uint32_t t : cache->baked) {
+		CollisionTriangle const &tri = static_collision->triangles[t];
+		if (std::abs(glm::dot(tri.normal, center) - tri.offset) > reach) continue;
+		add_triangle(static_collision->colliders[t], tri.a, tri.b, tri.c);
+	}
+	for (auto const &tri : cache->moved) {
+		add_triangle(tri.collider, tri.a, tri.b, tri.c);
+	}
+	for (uint32_t id : cache->primitives) {
+		add_primitive(id, colliders[id].world_primitive);
+	}
+}
+
+//The velocity closest to 'velocity' that doesn't point into any of the manifold's contacts:
+// (i.e., the projection onto the cone { v : dot(v, out) >= 0 for every contact },
+//  found by trying each set of one or two contacts as the ones the result slides along)
+static glm::vec3 project_onto_contacts(glm::vec3 const &velocity, CollisionWorld::Manifold const &manifold) {
+	auto allowed = [&](glm::vec3 const &v) {
+		for (uint32_t i = 0; i < manifold.count; ++i) {
+			if (glm::dot(v, manifold.contacts[i].out) < -1e-5f) return false;
+		}
+		return true;
+	};
+	if (allowed(velocity)) return velocity;
+
+	//sliding along three or more contacts means not moving at all:
+	glm::vec3 best = glm::vec3(0.0f);
+	float best_change = glm::dot(velocity, velocity);
+	auto consider = [&](glm::vec3 const &v) {
+		glm::vec3 change = v - velocity;
+		float change2 = glm::dot(change, change);
+		if (change2 < best_change && allowed(v)) {
+			best = v;
+			best_change = change2;
+		}
+	};
+	for (uint32_t i = 0; i < manifold.count; ++i) {
+		glm::vec3 const &a = manifold.contacts[i].out;
+		//slide along contact i's surface:
+		consider(velocity - glm::dot(velocity, a) * a);
+		for (uint32_t j = i + 1; j < manifold.count; ++j) {
+			//slide along the crease between contacts i and j:
+			glm::vec3 crease = glm::cross(a, manifold.contacts[j].out);
+			float length2 = glm::dot(crease, crease);
+			if (length2 < 1e-6f) continue;
+			consider((glm::dot(velocity, crease) / length2) * crease);
+		}
+	}
+	return best;
+}
+
+void CollisionWorld::slide_sphere(glm::vec3 *position_, glm::vec3 *velocity_, float radius, float elapsed,
+	std::function< void(Hit const &, glm::vec3 const &position, glm::vec3 *velocity) > const &on_hit,
+	uint32_t layers, DebugDraw const *debug, uint32_t max_iterations, SlideCache *cache) const {
+	QueryScope scope(*this);
+	assert(position_);
+	assert(velocity_);
+	glm::vec3 &position = *position_;
+	glm::vec3 &velocity = *velocity_;
+
+	glm::vec3 start_position = position; //(for tracing)
+	glm::vec3 start_velocity = velocity;
+	bool hit_anything = false;
+
+	if (cache && !(use_distance_field && distance_field())) {
+		//responses never speed the sphere up, so it stays within this box for the whole move:
+		// (if a custom response does, the sweep that leaves the box gathers again;
+		//  the box is padded so contacts can be gathered from the cache at the end of any sweep)
+		glm::vec3 reach = glm::vec3(glm::length(velocity) * elapsed + radius + ContactSkin);
+		gather_candidates(position - reach, position + reach, layers, cache);
+	}
+
+	float remain = elapsed;
+	for (uint32_t iter = 0; iter < max_iterations; ++iter) {
+		if (remain == 0.0f) break;
+
+		glm::vec3 sweep_from = position;
+		glm::vec3 sweep_to = position + velocity * remain;
+
+		//(only draw tested geometry for the first sweep)
+		DebugDraw const *iter_debug = (iter == 0 ? debug : nullptr);
+		Hit hit;
+		bool collided;
+		if (cache) cache->iterations += 1;
+		if (use_distance_field && distance_field()) {
+			collided = sweep_sphere_distance_field(sweep_from, sweep_to, radius, &hit, layers, iter_debug);
+		} else if (cache) {
+			glm::vec3 sweep_min = glm::min(sweep_from, sweep_to) - glm::vec3(radius);
+			glm::vec3 sweep_max = glm::max(sweep_from, sweep_to) + glm::vec3(radius);
+			if (sweep_min.x < cache->min.x || sweep_min.y < cache->min.y || sweep_min.z < cache->min.z
+			 || sweep_max.x > cache->max.x || sweep_max.y > cache->max.y || sweep_max.z > cache->max.z) {
+				gather_candidates(sweep_min - glm::vec3(ContactSkin), sweep_max + glm::vec3(ContactSkin), layers, cache);
+			}
+			if (iter_debug && iter_debug->lines && iter_debug->show_geometry) {
+				draw_collider_bounds(*this, *iter_debug->lines, sweep_min, sweep_max, layers);
+			}
+			collided = sweep_sphere_cached(sweep_from, sweep_to, radius, &hit, cache, iter_debug);
+		} else {
+			collided = sweep_sphere(sweep_from, sweep_to, radius, &hit, layers, iter_debug);
+		}
+		if (!collided) {
+			position = sweep_to;
+			remain = 0.0f;
+			break;
+		}
+
+		position = glm::mix(sweep_from, sweep_to, hit.t);
+		hit_anything = true;
+
+		//everything else the sphere touches here is resolved along with the hit, so corners don't take an iteration per face:
+		// (the distance field doesn't report individual surfaces, so hits on it are resolved alone)
+		Manifold manifold;
+		manifold.add(hit);
+		if (!(use_distance_field && distance_field())) {
+			gather_contacts(position, radius, ContactSkin, &manifold, layers, cache);
+		}
+		if (cache) cache->contacts += manifold.count;
+
+		for (uint32_t i = 0; i < manifold.count; ++i) {
+			Hit contact = manifold.contacts[i];
+			contact.t = hit.t;
+			if (on_hit) {
+				on_hit(contact, position, &velocity);
+			} else {
+				float d = glm::dot(velocity, contact.out);
+				if (d < 0.0f) {
+					velocity -= (1.1f * d) * contact.out;
+				}
+			}
+			if (debug && debug->lines && debug->show_collision) {
+				draw_contact(*debug->lines, contact.at, contact.out);
+			}
+		}
+		//(responses to one contact may push into another)
+		if (manifold.count > 1) velocity = project_onto_contacts(velocity, manifold);
+
+		remain = (1.0f - hit.t) * remain;
+	}
+
+	if (trace && scope.outermost()) {
+		CollisionTrace::Record record;
+		record.kind = CollisionTrace::SlideSphere;
+		record.layers = layers;
+		record.from = start_position;
+		record.to = start_velocity;
+		record.radius = radius;
+		record.elapsed = elapsed;
+		record.use_distance_field = use_distance_field;
+		record.collided = hit_anything;
+		record.at = position;
+		record.out = velocity;
+		trace->record(record);
+	}
+}
@@ -0,0 +1,311 @@
+#pragma once
+
+/*
+ * A CollisionWorld holds all of the colliders in a level and answers
+ *  collision queries against them:
+ *  - sweep_sphere / sweep_spheres: first hit of a moving sphere (or of many at once),
+ *  - raycast / raycast_any: first (or any) hit of a line segment,
+ *  - overlap_sphere / overlap_swept_sphere: which colliders a (moving) sphere touches,
+ *  - slide_sphere: move a sphere, sliding along whatever it hits.
+ *
+ * Internally, colliders that don't move are baked into world-space geometry
+ *  (StaticCollision, shared between copies of the world), while colliders
+ *  that have moved since baking are found through a broadphase tree and
+ *  tested through their mesh's triangle hierarchy.
+ *
+ * Colliders can also be analytic shapes (boxes, capsules, spheres), which
+ *  take a single closed-form test instead of one per triangle. These are
+ *  never baked, so they are always found through the broadphase tree.
+ *
+ * Optionally, the baked geometry can also be turned into a DistanceField,
+ *  which sweeps (and slides) can use instead of testing triangles.
+ *
+ * Sweeps, raycasts, and slides can be recorded into a CollisionTrace
+ *  (for replaying later as a benchmark), and their cost can be counted
+ *  per collider in a CollisionStats (to find expensive level geometry).
+ *
+ */
+
+#include "Scene.hpp"
+#include "Mesh.hpp"
+#include "ColliderTree.hpp"
+#include "StaticCollision.hpp"
+#include "DistanceField.hpp"
+#include "collide.hpp"
+
+struct CollisionTrace;
+struct CollisionStats;
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+struct DrawLines;
+
+struct CollisionWorld {
+	//Colliders are assigned to layers; queries only look at colliders in the layers they ask for:
+	enum Layer : uint32_t {
+		LayerSolid = 0x1, //things to bump into
+		LayerAll = 0xffffffff
+	};
+
+	//Register a collider (before bake()); returns its id (index in 'colliders'):
+	uint32_t add_mesh(Scene::Transform *transform, Mesh const &mesh, MeshData const &buffer, uint32_t layers = LayerSolid);
+	// ...or an analytic shape (given in the transform's local space):
+	uint32_t add_primitive(Scene::Transform *transform, CollisionPrimitive const &primitive, uint32_t layers = LayerSolid);
+
+	//Bake all colliders into world-space static geometry (call once, after adding colliders):
+	void bake();
+
+	//Turn baked geometry into a distance field (call after bake(); does nothing if the field is already built):
+	// (this is slow -- seconds on a large level -- so is best put off until the field is wanted)
+	void build_distance_field(float voxel_size = 0.25f, float band = 1.5f);
+
+	//...or build it on another thread, so the game keeps running meanwhile:
+	// (does nothing if the field is already built or being built; queries test triangles until it is done)
+	void start_distance_field(float voxel_size = 0.25f, float band = 1.5f);
+	//Start using the field once its build has finished (call from the thread that makes queries, e.g., each update):
+	// (returns true if it did so in this call)
+	bool finish_distance_field();
+
+	//The distance field, if build_distance_field() has been called (on this world or any copy of it):
+	DistanceField const *distance_field() const { return shared_distance_field ? shared_distance_field->field.get() : nullptr; }
+
+	//Use the distance field (when it has been built and can be used) instead of triangles in slide_sphere:
+	bool use_distance_field = false;
+
+	//Tell the world that collider 'id's transform has moved:
+	// (the collider will then be tested from its mesh rather than from baked geometry)
+	void collider_moved(uint32_t id);
+
+	//Which colliders have moved (and where to), for restoring a world cheaply:
+	// (with Scene::Snapshot, e.g., to restart a level without copying it again)
+	struct Snapshot;
+	void save(Snapshot *snapshot) const;
+	//(call after restoring the scene: colliders that moved after the snapshot was saved are re-placed from their transforms)
+	void restore(Snapshot const &snapshot);
+
+	//When copying a scene along with its collision world, point colliders at the copied transforms:
+	void remap_transforms(std::unordered_map< Scene::Transform const *, Scene::Transform * > const &transform_to_transform);
+
+	//----- queries -----
+
+	struct Hit {
+		float t = 1.0f; //time along query where hit happens (in [0,1])
+		glm::vec3 at = glm::vec3(0.0f); //point of contact
+		glm::vec3 out = glm::vec3(0.0f); //direction out of surface at contact
+		uint32_t collider = -1U; //id of collider that was hit
+	};
+
+	//optional debug visualization of what a query tested:
+	struct DebugDraw {
+		DrawLines *lines = nullptr;
+		bool show_geometry = false; //draw bounds and triangles that were tested
+		bool show_collision = false; //highlight triangles that were hit and contact points
+	};
+
+	//First hit of sphere moving from 'from' to 'to':
+	// returns true (and fills in 'hit', if given) if something was hit.
+	bool sweep_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit,
+		uint32_t layers = LayerSolid, DebugDraw const *debug = nullptr) const;
+
+	//Many sphere sweeps at once (e.g., player, camera probes, particles), as given to / filled in by sweep_spheres:
+	struct SphereCast {
+		glm::vec3 from = glm::vec3(0.0f);
+		glm::vec3 to = glm::vec3(0.0f);
+		float radius = 0.0f;
+		//results:
+		bool collided = false;
+		Hit hit;
+	};
+
+	//First hit of each sweep in 'casts' (one sweep_sphere each):
+	void sweep_spheres(std::vector< SphereCast > *casts, uint32_t layers = LayerSolid) const;
+
+	//Like sweep_sphere, but by sphere tracing the distance field:
+	// (falls back to sweep_sphere if there is no field, a collider has moved since baking,
+	//  or radius is too big for the field; hit.collider is -1U for hits on the field)
+	bool sweep_sphere_distance_field(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit,
+		uint32_t layers = LayerSolid, DebugDraw const *debug = nullptr) const;
+
+	//First hit of the segment from 'from' to 'to':
+	// (hit.out is the surface normal on the side the segment came from)
+	bool raycast(glm::vec3 const &from, glm::vec3 const &to, Hit *hit,
+		uint32_t layers = LayerSolid) const;
+
+	//Does the segment from 'from' to 'to' hit anything at all?
+	// (cheaper than raycast() since it stops at the first hit found; useful for line-of-sight checks)
+	bool raycast_any(glm::vec3 const &from, glm::vec3 const &to,
+		uint32_t layers = LayerSolid) const;
+
+	//Call 'fn(uint32_t id)' once for each collider whose surface is within 'radius' of 'center':
+	// ('fn' is called after the search is done, so it may make queries of its own)
+	template< typename F >
+	void overlap_sphere(glm::vec3 const &center, float radius, F const &fn,
+		uint32_t layers = LayerAll) const;
+
+	//Call 'fn(uint32_t id)' once for each collider that the sphere moving from 'from' to 'to' touches:
+	template< typename F >
+	void overlap_swept_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius, F const &fn,
+		uint32_t layers = LayerAll) const;
+
+	//Per-sphere state that lets slide_sphere reuse work between its iterations and between frames:
+	struct SlideCache {
+		//candidate triangles near the whole frame's motion (gathered once per slide_sphere call):
+		std::vector< uint32_t > baked; //indices into static_collision->triangles
+		struct MovedTriangle {
+			glm::vec3 a, b, c; //world-space corners
+			uint32_t collider; //collider id
+			uint32_t vertex; //first vertex in collider's buffer
+		};
+		std::vector< MovedTriangle > moved; //triangles of colliders that have moved
+		std::vector< uint32_t > primitives; //ids of primitive colliders
+		glm::vec3 min = glm::vec3(0.0f); //box candidates were gathered for
+		glm::vec3 max = glm::vec3(0.0f);
+
+		//triangles hit during the last slide_sphere call (tested first next time, to find the likely hit early):
+		std::vector< uint32_t > baked_contacts;
+		std::vector< std::pair< uint32_t, uint32_t > > moved_contacts; //(collider, vertex)
+
+		//counters (only ever incremented; reset them as needed):
+		uint64_t gathers = 0; //candidate gathers (hierarchy walks)
+		uint64_t iterations = 0; //slide iterations (sweeps)
+		uint64_t contacts = 0; //contacts resolved (more than one per hit when the sphere touches several surfaces)
+		uint64_t triangle_tests = 0; //exact swept-sphere vs triangle (or primitive) tests
+		uint64_t triangles_skipped = 0; //cached candidates rejected by a cheap bounds or plane check instead
+	};
+
+	//Surfaces a sphere touches at the same time (e.g., the faces of a corner it has rolled into):
+	enum : uint32_t { MaxContacts = 4 };
+	struct Manifold {
+		Hit contacts[MaxContacts];
+		uint32_t count = 0;
+		//add 'hit' unless a contact facing (nearly) the same way is already present or the manifold is full:
+		void add(Hit const &hit);
+	};
+
+	//Add to 'manifold' every surface within 'skin' of the sphere at 'center':
+	// (if 'cache' is given, only its candidates are checked; the sphere must be inside the cache's box)
+	void gather_contacts(glm::vec3 const &center, float radius, float skin, Manifold *manifold,
+		uint32_t layers = LayerSolid, SlideCache const *cache = nullptr) const;
+
+	//Move a sphere at 'position' with 'velocity' for 'elapsed' seconds, stopping at each hit:
+	// At each hit, every surface the sphere is touching is gathered into a Manifold and resolved together:
+	// 'on_hit' (if given) adjusts velocity for each contact; by default, velocity into the surface is removed (with a bit of bounce).
+	// Afterward, whatever velocity still points into a contact is removed, so corners and seams settle in an iteration or two.
+	// At most 'max_iterations' hits are handled.
+	// If 'cache' is given, candidate triangles are gathered once for the whole move (and the cache is updated).
+	void slide_sphere(glm::vec3 *position, glm::vec3 *velocity, float radius, float elapsed,
+		std::function< void(Hit const &, glm::vec3 const &position, glm::vec3 *velocity) > const &on_hit = nullptr,
+		uint32_t layers = LayerSolid, DebugDraw const *debug = nullptr, uint32_t max_iterations = 10,
+		SlideCache *cache = nullptr) const;
+
+	//----- data -----
+
+	struct Collider {
+		Collider(Scene::Transform *transform_, Mesh const &mesh_, MeshData const &buffer_, uint32_t layers_)
+			: transform(transform_), mesh(&mesh_), buffer(&buffer_), layers(layers_) { }
+		Collider(Scene::Transform *transform_, CollisionPrimitive const &primitive_, uint32_t layers_)
+			: transform(transform_), primitive(primitive_), layers(layers_) { }
+		Scene::Transform *transform;
+		Mesh const *mesh = nullptr; //(nullptr for primitive colliders)
+		MeshData const *buffer = nullptr;
+		CollisionPrimitive primitive; //(local space; only used if mesh is nullptr)
+		uint32_t layers;
+
+		//cached from transform (at bake() and collider_moved()):
+		glm::mat4x3 to_world = glm::mat4x3(1.0f);
+		glm::mat4x3 to_local = glm::mat4x3(1.0f);
+		glm::vec3 world_min = glm::vec3(0.0f);
+		glm::vec3 world_max = glm::vec3(0.0f);
+		CollisionPrimitive world_primitive;
+
+		//is collider's geometry (still) part of static_collision?
+		bool baked = false;
+		//has collider_moved() been called for it since bake()?
+		bool moved = false;
+	};
+	std::vector< Collider > colliders;
+
+	//World-space triangles of colliders, baked by bake():
+	//  (shared -- not copied -- between a world and its copies)
+	std::shared_ptr< StaticCollision const > static_collision;
+
+	//Broadphase over colliders that are *not* baked:
+	// (a dynamic AABB tree, so moving a collider costs O(log n) rather than a rebuild)
+	ColliderTree moved_tree;
+
+	//ids of colliders that have moved since bake(), in the order they first moved:
+	std::vector< uint32_t > moved;
+	//number of those that were baked (so whose baked geometry is out of date):
+	uint32_t moved_count = 0;
+
+	struct Snapshot {
+		//the colliders listed in 'moved' when the snapshot was saved, as they were then:
+		// (the world's later entries in 'moved' have moved since)
+		std::vector< Collider > moved;
+		uint32_t moved_count = 0;
+	};
+
+	//Distance field over static_collision, made by build_distance_field():
+	//  (shared -- not copied -- like static_collision; the holder is made by bake(), so copies
+	//   of a world share its field even if it is only built after they were copied)
+	struct SharedDistanceField {
+		std::shared_ptr< DistanceField const > field;
+		//field being built by start_distance_field() (waited for, if still running, when the holder goes away):
+		std::future< std::shared_ptr< DistanceField const > > building;
+	};
+	std::shared_ptr< SharedDistanceField > shared_distance_field;
+
+	//If set, queries (and their results) are recorded here:
+	// (not owned; see CollisionTrace.hpp)
+	CollisionTrace *trace = nullptr;
+
+	//If set, the work queries do is counted here, per collider:
+	// (not owned; see CollisionStats.hpp)
+	CollisionStats *stats = nullptr;
+
+	//-- internals --
+
+	//refresh cached matrices and bounds of a collider:
+	static void update_cache(Collider &collider);
+
+	//fill cache with candidate triangles (in 'layers') that might touch box [min,max]:
+	// (last call's contacts are moved to the front of the candidate lists, then cleared)
+	void gather_candidates(glm::vec3 const &min, glm::vec3 const &max, uint32_t layers, SlideCache *cache) const;
+
+	//contacts are gathered within this distance of the sphere (on top of its radius) after each hit in slide_sphere:
+	static constexpr float ContactSkin = 1e-2f;
+
+	//like sweep_sphere, but only tests the triangles in cache (sweep must be inside cache's box):
+	// (the triangle that is hit is added to the cache's contacts)
+	bool sweep_sphere_cached(glm::vec3 const &from, glm::vec3 const &to, float radius, Hit *hit,
+		SlideCache *cache, DebugDraw const *debug) const;
+
+	//overlap queries hand their results to 'fn' through this (a pointer to it and a function to call it; no allocation):
+	struct OverlapFn {
+		template< typename F >
+		OverlapFn(F const &fn) : data(&fn), call([](void const *data, uint32_t id){ (*static_cast< F const * >(data))(id); }) { }
+		void operator()(uint32_t id) const { call(data, id); }
+		void const *data;
+		void (*call)(void const *data, uint32_t id);
+	};
+	void overlap_sphere_fn(glm::vec3 const &center, float radius, OverlapFn const &fn, uint32_t layers) const;
+	void overlap_swept_sphere_fn(glm::vec3 const &from, glm::vec3 const &to, float radius, OverlapFn const &fn, uint32_t layers) const;
+};
+
+//---------------------------
+
+template< typename F >
+void CollisionWorld::overlap_sphere(glm::vec3 const &center, float radius, F const &fn, uint32_t layers) const {
+	overlap_sphere_fn(center, radius, OverlapFn(fn), layers);
+}
+
+template< typename F >
+void CollisionWorld::overlap_swept_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius, F const &fn, uint32_t layers) const {
+	overlap_swept_sphere_fn(from, to, radius, OverlapFn(fn), layers);
+}
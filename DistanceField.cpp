@@ -0,0 +1,200 @@
+#include "DistanceField.hpp"
+
+#include "collide.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+//floor(a / b) for integers (rounds toward negative infinity, unlike '/'):
+static int32_t floor_div(int32_t a, int32_t b) {
+	int32_t q = a / b;
+	if ((a % b != 0) && ((a < 0) != (b < 0))) --q;
+	return q;
+}
+
+static glm::ivec3 floor_div(glm::ivec3 const &a, int32_t b) {
+	return glm::ivec3(floor_div(a.x, b), floor_div(a.y, b), floor_div(a.z, b));
+}
+
+uint64_t DistanceField::key_of(glm::ivec3 const &brick) {
+	return (uint64_t(uint32_t(brick.x) & 0x1fffff))
+	     | (uint64_t(uint32_t(brick.y) & 0x1fffff) << 21)
+	     | (uint64_t(uint32_t(brick.z) & 0x1fffff) << 42);
+}
+
+DistanceField::Brick const *DistanceField::find_brick(glm::ivec3 const &brick) const {
+	auto f = brick_index.find(key_of(brick));
+	if (f == brick_index.end()) return nullptr;
+	return &bricks[f->second];
+}
+
+DistanceField::DistanceField(StaticCollision const &geometry, float voxel_size_, float band_) : voxel_size(voxel_size_), band(band_) {
+	assert(voxel_size > 0.0f);
+	assert(band > voxel_size);
+
+	auto sample_at = [](int32_t x, int32_t y, int32_t z) -> uint32_t {
+		return uint32_t((z * BrickSamples + y) * BrickSamples + x);
+	};
+
+	for (CollisionTriangle const &tri : geometry.triangles) {
+		if (tri.features & CollisionTriangle::Degenerate) continue;
+
+		//samples within 'band' of the triangle's bounding box:
+		glm::vec3 tri_min = glm::min(glm::min(tri.a, tri.b), tri.c);
+		glm::vec3 tri_max = glm::max(glm::max(tri.a, tri.b), tri.c);
+		glm::ivec3 sample_min = glm::ivec3(glm::ceil((tri_min - glm::vec3(band)) / voxel_size));
+		glm::ivec3 sample_max = glm::ivec3(glm::floor((tri_max + glm::vec3(band)) / voxel_size));
+
+		//...but only those within 'band' of the triangle's plane can be within 'band' of the triangle,
+		// so walk columns along the axis closest to the normal ('k') and visit just that slab of each:
+		int32_t k = 0;
+		if (std::abs(tri.normal.y) > std::abs(tri.normal[k])) k = 1;
+		if (std::abs(tri.normal.z) > std::abs(tri.normal[k])) k = 2;
+		int32_t i = (k + 1) % 3;
+		int32_t j = (k + 2) % 3;
+		float slab = band / std::abs(tri.normal[k]); //(half-height of slab along k)
+		float brick_reach = band + 0.5f * float(BrickCells) * voxel_size
+			* (std::abs(tri.normal.x) + std::abs(tri.normal.y) + std::abs(tri.normal.z));
+
+		//bricks containing those samples: (bricks share their boundary samples)
+		glm::ivec3 brick_min = floor_div(sample_min - glm::ivec3(1), BrickCells);
+		glm::ivec3 brick_max = floor_div(sample_max, BrickCells);
+
+		for (int32_t bz = brick_min.z; bz <= brick_max.z; ++bz) {
+			for (int32_t by = brick_min.y; by <= brick_max.y; ++by) {
+				for (int32_t bx = brick_min.x; bx <= brick_max.x; ++bx) {
+					glm::ivec3 brick(bx, by, bz);
+					glm::ivec3 first = brick * int32_t(BrickCells);
+
+					//skip bricks the slab misses entirely:
+					glm::vec3 brick_center = (glm::vec3(first) + glm::vec3(0.5f * float(BrickCells))) * voxel_size;
+					if (std::abs(glm::dot(tri.normal, brick_center) - tri.offset) > brick_reach) continue;
+
+					auto ret = brick_index.insert(std::make_pair(key_of(brick), uint32_t(bricks.size())));
+					if (ret.second) {
+						bricks.emplace_back();
+						std::fill(std::begin(bricks.back().samples), std::end(bricks.back().samples), band);
+					}
+					Brick &b = bricks[ret.first->second];
+
+					glm::ivec3 lo = glm::max(sample_min - first, glm::ivec3(0));
+					glm::ivec3 hi = glm::min(sample_max - first, glm::ivec3(BrickCells));
+					glm::ivec3 local;
+					for (local[i] = lo[i]; local[i] <= hi[i]; ++local[i]) {
+						for (local[j] = lo[j]; local[j] <= hi[j]; ++local[j]) {
+							//where the column crosses the plane, and the part of it in the slab:
+							float across = (tri.offset
+								- tri.normal[i] * float(first[i] + local[i]) * voxel_size
+								- tri.normal[j] * float(first[j] + local[j]) * voxel_size) / tri.normal[k];
+							int32_t column_lo = std::max(lo[k], int32_t(std::ceil((across - slab) / voxel_size)) - first[k]);
+							int32_t column_hi = std::min(hi[k], int32_t(std::floor((across + slab) / voxel_size)) - first[k]);
+							for (local[k] = column_lo; local[k] <= column_hi; ++local[k]) {
+								glm::vec3 pt = glm::vec3(first + local) * voxel_size;
+								float &sample = b.samples[sample_at(local.x, local.y, local.z)];
+								//skip the exact test when the triangle's bounding box or plane is already farther than the sample:
+								float current = std::abs(sample);
+								glm::vec3 to_box = glm::max(glm::max(tri_min - pt, pt - tri_max), glm::vec3(0.0f));
+								if (glm::dot(to_box, to_box) >= current * current) continue;
+								if (std::abs(glm::dot(tri.normal, pt) - tri.offset) >= current) continue;
+								glm::vec3 from_tri = pt - closest_point_on_triangle(pt, tri.a, tri.b, tri.c);
+								float dist = glm::length(from_tri);
+								if (dist < current) {
+									sample = (glm::dot(from_tri, tri.normal) < 0.0f ? -dist : dist);
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+float DistanceField::distance(glm::vec3 const &pt) const {
+	//clamp to keep bricks representable in key_of's 21-bit fields:
+	float const limit = float(BrickCells) * 1048000.0f;
+	glm::vec3 cell = glm::clamp(pt / voxel_size, glm::vec3(-limit), glm::vec3(limit));
+	glm::vec3 cell_floor = glm::floor(cell);
+	glm::vec3 f = cell - cell_floor;
+	glm::ivec3 sample = glm::ivec3(cell_floor);
+
+	glm::ivec3 brick = floor_div(sample, BrickCells);
+	Brick const *b = find_brick(brick);
+	if (!b) return band;
+
+	glm::ivec3 l = sample - brick * int32_t(BrickCells);
+	auto at = [&](int32_t x, int32_t y, int32_t z) -> float {
+		return b->samples[((l.z + z) * BrickSamples + (l.y + y)) * BrickSamples + (l.x + x)];
+	};
+
+	//trilinear interpolation between the voxel's corner samples:
+	float x00 = glm::mix(at(0,0,0), at(1,0,0), f.x);
+	float x10 = glm::mix(at(0,1,0), at(1,1,0), f.x);
+	float x01 = glm::mix(at(0,0,1), at(1,0,1), f.x);
+	float x11 = glm::mix(at(0,1,1), at(1,1,1), f.x);
+	return glm::mix(glm::mix(x00, x10, f.y), glm::mix(x01, x11, f.y), f.z);
+}
+
+glm::vec3 DistanceField::gradient(glm::vec3 const &pt) const {
+	float h = 0.5f * voxel_size;
+	glm::vec3 g = glm::vec3(
+		distance(pt + glm::vec3(h, 0.0f, 0.0f)) - distance(pt - glm::vec3(h, 0.0f, 0.0f)),
+		distance(pt + glm::vec3(0.0f, h, 0.0f)) - distance(pt - glm::vec3(0.0f, h, 0.0f)),
+		distance(pt + glm::vec3(0.0f, 0.0f, h)) - distance(pt - glm::vec3(0.0f, 0.0f, h))
+	);
+	float len2 = glm::dot(g, g);
+	if (!(len2 > 0.0f)) return glm::vec3(0.0f, 0.0f, 1.0f);
+	return g / std::sqrt(len2);
+}
+
+bool DistanceField::sweep_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out, bool *incomplete) const {
+	assert(radius <= max_radius());
+	if (incomplete) *incomplete = false;
+
+	float t_max = 1.0f;
+	if (collision_t) {
+		t_max = std::min(t_max, *collision_t);
+		if (t_max <= 0.0f) return false;
+	}
+
+	glm::vec3 dir = to - from;
+	float len = glm::length(dir);
+
+	//sphere is considered touching when this close (interpolated distances are slightly off near corners):
+	float const skin = 0.25f * voxel_size;
+
+	//march along the sweep, each time stepping as far as the distance to the nearest surface:
+	float s = 0.0f; //distance travelled
+	for (uint32_t step = 0; step < MaxSteps; ++step) {
+		glm::vec3 pt = (len > 0.0f ? from + (s / len) * dir : from);
+		float gap = distance(pt) - radius;
+		if (gap <= skin) {
+			glm::vec3 out = gradient(pt);
+			if (glm::dot(out, dir) < 0.0f) {
+				if (collision_t) *collision_t = (len > 0.0f ? s / len : 0.0f);
+				if (collision_at) *collision_at = pt - (gap + radius) * out;
+				if (collision_out) *collision_out = out;
+				return true;
+			}
+			//touching, but moving away or along surface; keep going:
+			s += 0.5f * voxel_size;
+		} else {
+			s += gap;
+		}
+		if (s >= t_max * len) return false;
+	}
+
+	//ran out of steps (e.g., grazing a surface for a long way), so the rest of the sweep might not be clear:
+	if (incomplete) {
+		*incomplete = true;
+		return false;
+	}
+	//...stop where marching did, rather than risk passing through something:
+	glm::vec3 pt = (len > 0.0f ? from + (s / len) * dir : from);
+	glm::vec3 out = gradient(pt);
+	if (collision_t) *collision_t = (len > 0.0f ? s / len : 0.0f);
+	if (collision_at) *collision_at = pt - distance(pt) * out;
+	if (collision_out) *collision_out = out;
+	return true;
+}
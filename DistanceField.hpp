@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+ * A DistanceField is a sparse signed distance grid baked from (static,
+ *  world-space) level geometry:
+ *  - distances are sampled at the corners of cubic voxels,
+ *  - voxels are grouped into bricks, and only bricks near geometry are stored
+ *    (in a hash table); everywhere else the distance is at least 'band',
+ *  - sign comes from the face normal of the closest triangle (so is only
+ *    meaningful for closed, outward-facing meshes).
+ *
+ * Sweeping a sphere against the field (by sphere tracing) takes a number of
+ *  steps that depends on how close the sphere passes to geometry, not on how
+ *  many triangles there are.
+ *
+ */
+
+#include "StaticCollision.hpp"
+
+#include <glm/glm.hpp>
+
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+struct DistanceField {
+	//bake from all triangles in 'geometry':
+	// 'voxel_size' is the sample spacing; distances are exact (up to interpolation) within 'band' of a triangle.
+	DistanceField(StaticCollision const &geometry, float voxel_size = 0.25f, float band = 1.5f);
+
+	//(interpolated) signed distance at 'pt':
+	// (never more than 'band')
+	float distance(glm::vec3 const &pt) const;
+
+	//direction of increasing distance at 'pt' (i.e., outward normal near a surface):
+	glm::vec3 gradient(glm::vec3 const &pt) const;
+
+	//Sweep sphere from 'from' to 'to' by sphere tracing:
+	// returns true on hit, with *collision_t (in+out, like collide_swept_sphere_vs_triangle) set to the time of contact
+	// and *collision_at / *collision_out to the (approximate) contact point and outward direction.
+	// Spheres moving away from a surface they already touch don't collide with it.
+	// radius must be smaller than band - voxel_size (larger spheres can't tell "far" from "near")
+	// If marching runs out of steps first (e.g., rolling fast along a floor), whether the rest of the sweep is clear isn't known:
+	//  with 'incomplete' given, it is set and false is returned (so the caller can use an exact test instead);
+	//  without, a hit is reported where marching stopped (so nothing is ever tunnelled through).
+	bool sweep_sphere(glm::vec3 const &from, glm::vec3 const &to, float radius,
+		float *collision_t = nullptr, glm::vec3 *collision_at = nullptr, glm::vec3 *collision_out = nullptr,
+		bool *incomplete = nullptr) const;
+
+	//largest sphere radius sweep_sphere handles:
+	float max_radius() const { return band - voxel_size; }
+
+	//-- internals --
+
+	float voxel_size;
+	float band;
+
+	enum : int32_t {
+		BrickCells = 8, //voxels along each side of a brick
+		BrickSamples = BrickCells + 1, //samples along each side (bricks share samples on their faces)
+	};
+	struct Brick {
+		float samples[BrickSamples * BrickSamples * BrickSamples];
+	};
+	std::vector< Brick > bricks;
+
+	//brick coordinate key -> index in 'bricks':
+	std::unordered_map< uint64_t, uint32_t > brick_index;
+
+	static uint64_t key_of(glm::ivec3 const &brick);
+	Brick const *find_brick(glm::ivec3 const &brick) const;
+
+	//sphere tracing gives up after this many steps:
+	enum : uint32_t { MaxSteps = 128 };
+};
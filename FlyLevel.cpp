@@ -2,6 +2,7 @@
 #include "data_path.hpp"
 #include "LitColorTextureProgram.hpp"
 
+#include <cassert>
 #include <unordered_set>
 #include <unordered_map>
 #include <iostream>
@@ -10,8 +11,14 @@
 Mesh const *mesh_Goal = nullptr;
 Mesh const *mesh_Sphere = nullptr;
 
-//names of mesh-to-collider-mesh:
-std::unordered_map< Mesh const *, Mesh const * > mesh_to_collider;
+//what each mesh collides as -- either a (simpler) mesh or an analytic shape:
+struct ColliderShape {
+	ColliderShape(Mesh const *mesh_) : mesh(mesh_) { }
+	ColliderShape(CollisionPrimitive const &primitive_) : primitive(primitive_) { }
+	Mesh const *mesh = nullptr; //(nullptr for a primitive)
+	CollisionPrimitive primitive;
+};
+std::unordered_map< Mesh const *, ColliderShape > mesh_to_collider;
 
 GLuint fly_meshes_for_lit_color_texture_program = 0;
 
@@ -26,9 +33,10 @@ Load< MeshBuffer > fly_meshes(LoadTagDefault, []() -> MeshBuffer * {
 	mesh_Goal = &ret->lookup("Goal");
 	mesh_Sphere = &ret->lookup("Sphere");
 	
-	//these meshes collide as (simpler) boxes:
-	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Dark"), &ret->lookup("Block.Simple")));
-	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Light"), &ret->lookup("Block.Simple")));
+	//these meshes collide as boxes (with Block.Simple's bounds):
+	Mesh const &block = ret->lookup("Block.Simple");
+	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Dark"), CollisionPrimitive::box(block.min, block.max)));
+	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Light"), CollisionPrimitive::box(block.min, block.max)));
 	mesh_to_collider.insert( std::make_pair( &ret->lookup( "Goal" ), &ret->lookup( "Goal.Please" ) ) );
 
 	//these meshes collide as themselves:
@@ -68,6 +76,10 @@ FlyLevel::FlyLevel(std::string const &scene_file) {
 		pipeline.start = mesh->start;
 		pipeline.count = mesh->count;
 
+		//bounds for frustum culling:
+		drawables.back().min = mesh->min;
+		drawables.back().max = mesh->max;
+
 		
 
 		//associate level info with the drawable:
@@ -79,15 +91,19 @@ FlyLevel::FlyLevel(std::string const &scene_file) {
 		}
 		else if( mesh == mesh_Goal ) {
 			goals.emplace_back( transform );
+			//flying through the goal is detected with a box around its (collision) mesh:
 			auto f = mesh_to_collider.find( mesh );
-			if( f != mesh_to_collider.end() ) {
-				goal_colliders.emplace_back( transform, *f->second, *fly_meshes );
-			}
+			Mesh const &trigger_mesh = ( f != mesh_to_collider.end() && f->second.mesh ? *f->second.mesh : *mesh );
+			triggers.add_oriented_box( transform->make_local_to_world(), trigger_mesh.min, trigger_mesh.max, uint32_t( goals.size() - 1 ) );
 		}
 		else {
 			auto f = mesh_to_collider.find(mesh);
 			if (f != mesh_to_collider.end()) {
-				mesh_colliders.emplace_back(transform, *f->second, *fly_meshes);
+				if (f->second.mesh) {
+					collision.add_mesh(transform, *f->second.mesh, *fly_meshes);
+				} else {
+					collision.add_primitive(transform, f->second.primitive);
+				}
 			} else {
 				//just decoration.
 				++decorations;
@@ -99,9 +115,13 @@ FlyLevel::FlyLevel(std::string const &scene_file) {
 		throw std::runtime_error("Level '" + scene_file + "' contains no Sphere (starting location).");
 	}
 
+	//bake colliders into world-space static geometry:
+	// (the distance field is only built if it is switched on -- see FlyMode)
+	collision.bake();
+
 	std::cout << "Level '" << scene_file << "' has "
-		<< mesh_colliders.size() << " mesh colliders, "
-		<< goal_colliders.size() << " goal colliders, "
+		<< collision.colliders.size() << " mesh colliders, "
+		<< triggers.volumes.size() << " triggers, "
 		<< goals.size() << " goals "
 		<< "and " << decorations << " decorations."
 		<< std::endl;
@@ -119,6 +139,15 @@ FlyLevel::FlyLevel(FlyLevel const &other) {
 	*this = other;
 }
 FlyLevel &FlyLevel::operator=(FlyLevel const &other) {
+	if (&other == this) return *this;
+
+	//replace (rather than add to) whatever was here before:
+	transforms.clear();
+	drawables.clear();
+	cameras.clear();
+	lamps.clear();
+	camera = nullptr;
+
 	//copy other's transforms, and remember the mapping between them and the copies:
 	std::unordered_map< Transform const *, Transform * > transform_to_transform;
 	//null transform maps to itself:
@@ -165,15 +194,10 @@ FlyLevel &FlyLevel::operator=(FlyLevel const &other) {
 	}
 
 	//---- level-specific stuff ----
-	mesh_colliders = other.mesh_colliders;
-	for (auto &c : mesh_colliders) {
-		c.transform = transform_to_transform.at(c.transform);
-	}
+	collision = other.collision;
+	collision.remap_transforms(transform_to_transform);
 
-	goal_colliders = other.goal_colliders;
-	for( auto &c : goal_colliders ) {
-		c.transform = transform_to_transform.at( c.transform );
-	}
+	triggers = other.triggers;
 
 	goals = other.goals;
 	for (auto &g : goals) {
@@ -186,3 +210,17 @@ FlyLevel &FlyLevel::operator=(FlyLevel const &other) {
 	return *this;
 }
 
+void FlyLevel::save(Snapshot *snapshot) const {
+	assert(snapshot);
+	Scene::save(&snapshot->scene);
+	snapshot->goals = goals;
+	snapshot->player = player;
+	collision.save(&snapshot->collision);
+}
+
+void FlyLevel::restore(Snapshot const &snapshot) {
+	Scene::restore(snapshot.scene);
+	goals = snapshot.goals;
+	player = snapshot.player;
+	collision.restore(snapshot.collision);
+}
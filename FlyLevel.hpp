@@ -8,6 +8,10 @@
 #include "Scene.hpp"
 #include "Mesh.hpp"
 #include "Load.hpp"
+#include "CollisionWorld.hpp"
+#include "Triggers.hpp"
+
+#include <memory>
 
 struct FlyLevel;
 
@@ -27,28 +31,14 @@ struct FlyLevel : Scene {
 	// copy constructor actually just uses this = operator:
 	FlyLevel &operator=(FlyLevel const &);
 
-	
-	//Solid parts of level are tracked as MeshColliders:
-	struct MeshCollider {
-		MeshCollider(Scene::Transform *transform_, Mesh const &mesh_, MeshBuffer const &buffer_) : transform(transform_), mesh(&mesh_), buffer(&buffer_) { }
-		Scene::Transform *transform;
-		Mesh const *mesh;
-		MeshBuffer const *buffer;
-	};
 
-	struct GoalCollider {
-		GoalCollider( Scene::Transform *transform_, Mesh const &mesh_, MeshBuffer const &buffer_ ) : transform( transform_ ), mesh( &mesh_ ), buffer( &buffer_ ) { }
-		Scene::Transform *transform;
-		Mesh const *mesh;
-		MeshBuffer const *buffer;
-		bool isCollided = false;
-	};
 
 	//Goal objects(s) tracked using this structure:
 	struct Goal {
 		Goal(Scene::Transform *transform_) : transform(transform_) { };
 		Scene::Transform *transform;
 		float spin_acc = 0.0f;
+		bool passed = false; //has player flown through this goal?
 	};
 
 	//Sphere being rolled tracked using this structure:
@@ -62,11 +52,26 @@ struct FlyLevel : Scene {
 	};
 
 	//Additional information for things in the level:
-	std::vector< GoalCollider > goal_colliders;
-	std::vector< MeshCollider > mesh_colliders;
 	std::vector< Goal > goals;
 	Player player;
 
+	//Solid parts of level as mesh colliders:
+	CollisionWorld collision;
+
+	//Everything that changes during play, for restarting without copying the whole level again:
+	struct Snapshot {
+		Scene::Snapshot scene;
+		std::vector< Goal > goals;
+		Player player;
+		CollisionWorld::Snapshot collision;
+	};
+	void save(Snapshot *snapshot) const;
+	//(objects added since the snapshot was saved -- e.g., debris -- are removed)
+	void restore(Snapshot const &snapshot);
+
+	//Trigger volumes; each goal has one (with 'user' set to the goal's index):
+	Triggers triggers;
+
 	Scene::Camera *camera = nullptr;
 };
 
@@ -6,7 +6,9 @@
 #include "DrawSprites.hpp"
 #include "data_path.hpp"
 #include "Sound.hpp"
-#include "collide.hpp"
+#include "CollisionWorld.hpp"
+#include "CollisionStats.hpp"
+#include "CollisionTrace.hpp"
 #include "gl_errors.hpp"
 
 //for glm::pow(quaternion, float):
@@ -19,7 +21,8 @@ Load< SpriteAtlas > font_atlas(LoadTagDefault, []() -> SpriteAtlas const * {
 	return new SpriteAtlas(data_path("trade-font"));
 });
 
-FlyMode::FlyMode( FlyLevel const &level_) : start(level_), level(level_) {
+FlyMode::FlyMode( FlyLevel const &level_) : level(level_) {
+	level.save(&level_start);
 	restart();
 }
 
@@ -39,6 +42,37 @@ bool FlyMode::handle_event(SDL_Event const &evt, glm::uvec2 const &window_size)
 		DEBUG_show_collision = !DEBUG_show_collision;
 		return true;
 	}
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_3) {
+		DEBUG_use_distance_field = !DEBUG_use_distance_field;
+		if (DEBUG_use_distance_field && !level.collision.distance_field()) {
+			//(built the first time it is wanted, in the background since it takes a while; shared with every copy of the level)
+			std::cout << "Building distance field (colliding with triangles until it is done)..." << std::endl;
+			level.collision.start_distance_field();
+		}
+		return true;
+	}
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_4) {
+		drop_debris();
+		return true;
+	}
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_5) {
+		toggle_trace();
+		return true;
+	}
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_6) {
+		//start counting (and showing) collision cost per collider, or stop:
+		if (!stats) {
+			stats.reset(new CollisionStats(level.collision));
+		} else {
+			stats.reset();
+		}
+		level.collision.stats = stats.get();
+		return true;
+	}
+	if (evt.type == SDL_KEYDOWN && evt.key.keysym.sym == SDLK_7) {
+		save_stats();
+		return true;
+	}
 
 
 
@@ -133,224 +167,47 @@ void FlyMode::update(float elapsed) {
 		}
 		
 		//collide against level:
-		float remain = elapsed;
-		for (int32_t iter = 0; iter < 10; ++iter) {
-			if (remain == 0.0f) break;
-
-			float sphere_radius = 1.0f; //player sphere is radius-1
-			glm::vec3 sphere_sweep_from = position;
-			glm::vec3 sphere_sweep_to = position + velocity * remain;
-
-			glm::vec3 sphere_sweep_min = glm::min(sphere_sweep_from, sphere_sweep_to) - glm::vec3(sphere_radius);
-			glm::vec3 sphere_sweep_max = glm::max(sphere_sweep_from, sphere_sweep_to) + glm::vec3(sphere_radius);
-
-			bool collided = false;
-			float collision_t = 1.0f;
-			glm::vec3 collision_at = glm::vec3(0.0f);
-			glm::vec3 collision_out = glm::vec3(0.0f);
-
-			for( auto const &collider : level.goal_colliders ) {
-				glm::mat4x3 collider_to_world = collider.transform->make_local_to_world();
-				{ //Early discard:
-				  // check if AABB of collider overlaps AABB of swept sphere:
-
-				  //(1) compute bounding box of collider in world space:
-					glm::vec3 local_center = 0.5f * ( collider.mesh->max + collider.mesh->min );
-					glm::vec3 local_radius = 0.5f * ( collider.mesh->max - collider.mesh->min );
-
-					glm::vec3 world_min = collider_to_world * glm::vec4( local_center, 1.0f )
-						- glm::abs( local_radius.x * collider_to_world[0] )
-						- glm::abs( local_radius.y * collider_to_world[1] )
-						- glm::abs( local_radius.z * collider_to_world[2] );
-					glm::vec3 world_max = collider_to_world * glm::vec4( local_center, 1.0f )
-						+ glm::abs( local_radius.x * collider_to_world[0] )
-						+ glm::abs( local_radius.y * collider_to_world[1] )
-						+ glm::abs( local_radius.z * collider_to_world[2] );
-
-					//(2) check if bounding boxes overlap:
-					bool can_skip = !collide_AABB_vs_AABB( sphere_sweep_min, sphere_sweep_max, world_min, world_max );
-
-					//draw to indicate result of check:
-					if( iter == 0 && DEBUG_draw_lines && DEBUG_show_geometry ) {
-						DEBUG_draw_lines->draw_box( glm::mat4x3(
-							0.5f * ( world_max.x - world_min.x ), 0.0f, 0.0f,
-							0.0f, 0.5f * ( world_max.y - world_min.y ), 0.0f,
-							0.0f, 0.0f, 0.5f * ( world_max.z - world_min.z ),
-							0.5f * ( world_max.x + world_min.x ), 0.5f * ( world_max.y + world_min.y ), 0.5f * ( world_max.z + world_min.z )
-						), ( can_skip ? glm::u8vec4( 0x88, 0x88, 0x88, 0xff ) : glm::u8vec4( 0x88, 0x88, 0x00, 0xff ) ) );
-					}
-
-					if( can_skip ) {
-						//AABBs do not overlap; skip detailed check:
-						continue;
-					}
-				}
-
-				//Full (all triangles) test:
-				assert( collider.mesh->type == GL_TRIANGLES ); //only have code for TRIANGLES not other primitive types
-				for( GLuint v = 0; v + 2 < collider.mesh->count; v += 3 ) {
-					//get vertex positions from associated positions buffer:
-					//  (and transform to world space)
-					glm::vec3 a = collider_to_world * glm::vec4( collider.buffer->positions[collider.mesh->start + v + 0], 1.0f );
-					glm::vec3 b = collider_to_world * glm::vec4( collider.buffer->positions[collider.mesh->start + v + 1], 1.0f );
-					glm::vec3 c = collider_to_world * glm::vec4( collider.buffer->positions[collider.mesh->start + v + 2], 1.0f );
-					//check triangle:
-					bool did_collide = collide_swept_sphere_vs_triangle(
-						sphere_sweep_from, sphere_sweep_to, sphere_radius,
-						a, b, c,
-						&collision_t, &collision_at, &collision_out );
-
-					
-
-					if( did_collide && !collider.isCollided) {
-						const_cast<FlyLevel::GoalCollider&>(collider).isCollided = true;
-						goalsHit++;
-						if( goalsHit == level.goal_colliders.size() )
-						{
-							won = true;
-							time_record = time_record > 0.0f ? glm::min( time_record, time_run ) : time_run;
-						}
-					}
-
-					//draw to indicate result of check:
-					if( iter == 0 && DEBUG_draw_lines ) {
-						glm::u8vec4 color = ( did_collide ? glm::u8vec4( 0x88, 0x00, 0x00, 0xff ) : glm::u8vec4( 0x88, 0x88, 0x00, 0xff ) );
-						if( DEBUG_show_geometry || ( did_collide && DEBUG_show_collision ) ) {
-							DEBUG_draw_lines->draw( a, b, color );
-							DEBUG_draw_lines->draw( b, c, color );
-							DEBUG_draw_lines->draw( c, a, color );
-						}
-						//do a bit more to highlight colliding triangles (otherwise edges can be over-drawn by non-colliding triangles):
-						if( did_collide && DEBUG_show_collision ) {
-							glm::vec3 m = ( a + b + c ) / 3.0f;
-							DEBUG_draw_lines->draw( glm::mix( a, m, 0.1f ), glm::mix( b, m, 0.1f ), color );
-							DEBUG_draw_lines->draw( glm::mix( b, m, 0.1f ), glm::mix( c, m, 0.1f ), color );
-							DEBUG_draw_lines->draw( glm::mix( c, m, 0.1f ), glm::mix( a, m, 0.1f ), color );
-						}
-					}
-				}
-			}
-
-			for (auto const &collider : level.mesh_colliders) {
-				glm::mat4x3 collider_to_world = collider.transform->make_local_to_world();
-
-				{ //Early discard:
-					// check if AABB of collider overlaps AABB of swept sphere:
-
-					//(1) compute bounding box of collider in world space:
-					glm::vec3 local_center = 0.5f * (collider.mesh->max + collider.mesh->min);
-					glm::vec3 local_radius = 0.5f * (collider.mesh->max - collider.mesh->min);
-
-					glm::vec3 world_min = collider_to_world * glm::vec4(local_center, 1.0f)
-						- glm::abs(local_radius.x * collider_to_world[0])
-						- glm::abs(local_radius.y * collider_to_world[1])
-						- glm::abs(local_radius.z * collider_to_world[2]);
-					glm::vec3 world_max = collider_to_world * glm::vec4(local_center, 1.0f)
-						+ glm::abs(local_radius.x * collider_to_world[0])
-						+ glm::abs(local_radius.y * collider_to_world[1])
-						+ glm::abs(local_radius.z * collider_to_world[2]);
-
-					//(2) check if bounding boxes overlap:
-					bool can_skip = !collide_AABB_vs_AABB(sphere_sweep_min, sphere_sweep_max, world_min, world_max);
-
-					//draw to indicate result of check:
-					if (iter == 0 && DEBUG_draw_lines && DEBUG_show_geometry) {
-						DEBUG_draw_lines->draw_box(glm::mat4x3(
-							0.5f * (world_max.x - world_min.x), 0.0f, 0.0f,
-							0.0f, 0.5f * (world_max.y - world_min.y), 0.0f,
-							0.0f, 0.0f, 0.5f * (world_max.z - world_min.z),
-							0.5f * (world_max.x+world_min.x), 0.5f * (world_max.y+world_min.y), 0.5f * (world_max.z+world_min.z)
-						), (can_skip ? glm::u8vec4(0x88, 0x88, 0x88, 0xff) : glm::u8vec4(0x88, 0x88, 0x00, 0xff) ) );
-					}
-
-					if (can_skip) {
-						//AABBs do not overlap; skip detailed check:
-						continue;
-					}
-				}
-
-				//Full (all triangles) test:
-				assert(collider.mesh->type == GL_TRIANGLES); //only have code for TRIANGLES not other primitive types
-				for (GLuint v = 0; v + 2 < collider.mesh->count; v += 3) {
-					//get vertex positions from associated positions buffer:
-					//  (and transform to world space)
-					glm::vec3 a = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+0], 1.0f);
-					glm::vec3 b = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+1], 1.0f);
-					glm::vec3 c = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+2], 1.0f);
-					//check triangle:
-					bool did_collide = collide_swept_sphere_vs_triangle(
-						sphere_sweep_from, sphere_sweep_to, sphere_radius,
-						a,b,c,
-						&collision_t, &collision_at, &collision_out);
-
-					if (did_collide) {
-						collided = true;
-					}
-
-					//draw to indicate result of check:
-					if (iter == 0 && DEBUG_draw_lines) {
-						glm::u8vec4 color = (did_collide ? glm::u8vec4(0x88, 0x00, 0x00, 0xff) : glm::u8vec4(0x88, 0x88, 0x00, 0xff));
-						if (DEBUG_show_geometry || (did_collide && DEBUG_show_collision)) {
-							DEBUG_draw_lines->draw(a,b,color);
-							DEBUG_draw_lines->draw(b,c,color);
-							DEBUG_draw_lines->draw(c,a,color);
-						}
-						//do a bit more to highlight colliding triangles (otherwise edges can be over-drawn by non-colliding triangles):
-						if (did_collide && DEBUG_show_collision) {
-							glm::vec3 m = (a + b + c) / 3.0f;
-							DEBUG_draw_lines->draw(glm::mix(a,m,0.1f),glm::mix(b,m,0.1f),color);
-							DEBUG_draw_lines->draw(glm::mix(b,m,0.1f),glm::mix(c,m,0.1f),color);
-							DEBUG_draw_lines->draw(glm::mix(c,m,0.1f),glm::mix(a,m,0.1f),color);
-						}
-					}
-				}
-			}
+		float sphere_radius = 1.0f; //player sphere is radius-1
+		CollisionWorld::DebugDraw debug;
+		debug.lines = DEBUG_draw_lines.get();
+		debug.show_geometry = DEBUG_show_geometry;
+		debug.show_collision = DEBUG_show_collision;
+		glm::vec3 start_position = position;
+		//(a distance field being built is picked up as soon as it is done; triangles are used until then)
+		if (level.collision.finish_distance_field()) {
+			std::cout << "Distance field built." << std::endl;
+		}
+		level.collision.use_distance_field = DEBUG_use_distance_field;
 
-			if (!collided) {
-				position = sphere_sweep_to;
-				remain = 0.0f;
-				break;
-			} else {
-				position = glm::mix(sphere_sweep_from, sphere_sweep_to, collision_t);
-				float d = glm::dot(velocity, collision_out);
+		level.collision.slide_sphere(&position, &velocity, sphere_radius, elapsed,
+			[&](CollisionWorld::Hit const &hit, glm::vec3 const &at, glm::vec3 *velocity_) {
+				glm::vec3 &velocity = *velocity_;
+				float d = glm::dot(velocity, hit.out);
 				if (d < 0.0f) {
-					velocity -= (1.1f * d) * collision_out;
+					velocity -= (1.1f * d) * hit.out;
 
 					//update rotational velocity to reflect relative motion:
-					glm::vec3 slip = glm::cross(rotational_velocity, collision_at - position) + velocity;
-					//DEBUG: std::cout << "slip: " << slip.x << " " << slip.y << " " << slip.z << std::endl;
-					/*if (DEBUG_draw_lines) {
-						DEBUG_draw_lines->draw(collision_at, collision_at + slip, glm::u8vec4(0x00, 0xff, 0x00, 0xff));
-					}*/
-					glm::vec3 change = glm::cross(slip, collision_at - position);
+					glm::vec3 slip = glm::cross(rotational_velocity, hit.at - at) + velocity;
+					glm::vec3 change = glm::cross(slip, hit.at - at);
 					rotational_velocity += change;
 				}
-				if (DEBUG_draw_lines && DEBUG_show_collision) {
-					//draw a little gadget at the collision point:
-					glm::vec3 p1;
-					if (std::abs(collision_out.x) <= std::abs(collision_out.y) && std::abs(collision_out.x) <= std::abs(collision_out.z)) {
-						p1 = glm::vec3(1.0f, 0.0f, 0.0f);
-					} else if (std::abs(collision_out.y) <= std::abs(collision_out.z)) {
-						p1 = glm::vec3(0.0f, 1.0f, 0.0f);
-					} else {
-						p1 = glm::vec3(0.0f, 0.0f, 1.0f);
-					}
-					p1 = glm::normalize(p1 - glm::dot(p1, collision_out)*collision_out);
-					glm::vec3 p2 = glm::cross(collision_out, p1);
-
-					float r = 0.25f;
-					glm::u8vec4 color = glm::u8vec4(0xff, 0x00, 0x00, 0xff);
-					DEBUG_draw_lines->draw(collision_at + r*p1, collision_at + r*p2, color);
-					DEBUG_draw_lines->draw(collision_at + r*p2, collision_at - r*p1, color);
-					DEBUG_draw_lines->draw(collision_at - r*p1, collision_at - r*p2, color);
-					DEBUG_draw_lines->draw(collision_at - r*p2, collision_at + r*p1, color);
-					DEBUG_draw_lines->draw(collision_at, collision_at + collision_out, color);
-				}
-				/*if (iter == 0) {
-					std::cout << collision_out.x << ", " << collision_out.y << ", " << collision_out.z
-					<< " / " << velocity.x << ", " << velocity.y << ", " << velocity.z << std::endl; //DEBUG
-				}*/
-				remain = (1.0f - collision_t) * remain;
+			},
+			CollisionWorld::LayerSolid, &debug, 10, &slide_cache);
+
+		//check for goals passed through along the way:
+		// (approximated by the straight path from start to end position)
+		trigger_events.clear();
+		level.triggers.update(start_position, position, sphere_radius, &trigger_events);
+		for( auto const &event : trigger_events ) {
+			if( !event.enter ) continue;
+			FlyLevel::Goal &goal = level.goals[event.user];
+			if( goal.passed ) continue;
+			goal.passed = true;
+			goalsHit++;
+			if( goalsHit == int( level.goals.size() ) )
+			{
+				won = true;
+				time_record = time_record > 0.0f ? glm::min( time_record, time_run ) : time_run;
 			}
 		}
 
@@ -363,6 +220,9 @@ void FlyMode::update(float elapsed) {
 		);
 	}
 
+	//loose spheres:
+	debris.step(level.collision, elapsed);
+
 	//goal update:
 	for (auto &goal : level.goals) {
 		goal.spin_acc += elapsed / 10.0f;
@@ -377,6 +237,58 @@ void FlyMode::update(float elapsed) {
 		;
 		glm::vec3 in = level.camera->transform->rotation * glm::vec3(0.0f, 0.0f, -1.0f);
 		level.camera->transform->position = level.player.transform->position - 7.0f * in - 0.1f * glm::length(level.player.velocity ) * in;
+
+		//pull camera in front of any level geometry between it and the player:
+		glm::vec3 const &target = level.player.transform->position;
+		glm::vec3 &camera_position = level.camera->transform->position;
+		CollisionWorld::Hit hit;
+		if (level.collision.raycast(target, camera_position, &hit)) {
+			camera_position = hit.at + 0.2f * hit.out;
+		}
+	}
+
+	//collision cost heatmap:
+	if (stats) {
+		stats->next_frame();
+		if (DEBUG_draw_lines) stats->draw_heatmap(level.collision, *DEBUG_draw_lines);
+	}
+}
+
+void FlyMode::drop_debris() {
+	//draw debris with the same mesh as the player:
+	Scene::Drawable const *player_drawable = nullptr;
+	for (auto const &drawable : level.drawables) {
+		if (drawable.transform == level.player.transform) {
+			player_drawable = &drawable;
+			break;
+		}
+	}
+	if (!player_drawable) return;
+
+	//a 10x10x10 block of spheres above and in front of the player:
+	float const radius = 0.5f;
+	glm::vec3 center = level.player.transform->position + glm::vec3(0.0f, 0.0f, 15.0f)
+		+ 10.0f * glm::vec3(std::cos(level.player.view_azimuth + 0.5f * 3.1415926f), std::sin(level.player.view_azimuth + 0.5f * 3.1415926f), 0.0f);
+	for (uint32_t z = 0; z < 10; ++z) {
+		for (uint32_t y = 0; y < 10; ++y) {
+			for (uint32_t x = 0; x < 10; ++x) {
+				level.transforms.emplace_back();
+				Scene::Transform *transform = &level.transforms.back();
+				transform->name = "Debris";
+				transform->scale = glm::vec3(radius);
+				level.drawables.emplace_back(transform);
+				level.drawables.back().pipeline = player_drawable->pipeline;
+				level.drawables.back().min = player_drawable->min;
+				level.drawables.back().max = player_drawable->max;
+
+				debris.spheres.emplace_back();
+				SphereSim::Sphere &sphere = debris.spheres.back();
+				sphere.position = center + 2.2f * radius * (glm::vec3(x, y, z) - glm::vec3(4.5f, 4.5f, 0.0f));
+				sphere.radius = radius;
+				sphere.transform = transform;
+				transform->position = sphere.position;
+			}
+		}
 	}
 }
 
@@ -422,12 +334,47 @@ void FlyMode::draw(glm::uvec2 const &drawable_size) {
 }
 
 void FlyMode::restart() {
-	level = start;
+	//(cheaper than copying the level again, which copies and re-links every transform)
+	level.restore(level_start);
 	won = false;
 	time_run = 0.0f;
 	goalsHit = 0;
-	for( auto c : level.goal_colliders )
+	for( auto &g : level.goals )
 	{
-		const_cast<FlyLevel::GoalCollider&>( c ).isCollided = false;
+		g.passed = false;
+	}
+	level.triggers.reset();
+	debris.spheres.clear();
+}
+
+void FlyMode::toggle_trace() {
+	if (!trace) {
+		trace.reset(new CollisionTrace(level.collision));
+		level.collision.trace = trace.get();
+		std::cout << "Recording collision queries..." << std::endl;
+	} else {
+		level.collision.trace = nullptr;
+		std::string filename = "collision-trace.bin";
+		try {
+			trace->save(filename);
+			std::cout << "Saved " << trace->records.size() << " collision queries to '" << filename << "'." << std::endl;
+		} catch (std::exception &e) {
+			std::cerr << "Failed to save collision trace: " << e.what() << std::endl;
+		}
+		trace.reset();
+	}
+}
+
+void FlyMode::save_stats() {
+	if (!stats) {
+		std::cout << "Not counting collision cost; press '6' to start." << std::endl;
+		return;
+	}
+	std::string filename = "collision-stats.csv";
+	try {
+		stats->save_csv(level.collision, filename);
+		std::cout << "Saved collision cost of " << stats->frames << " frames to '" << filename << "'." << std::endl;
+	} catch (std::exception &e) {
+		std::cerr << "Failed to save collision stats: " << e.what() << std::endl;
 	}
 }
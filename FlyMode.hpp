@@ -3,6 +3,9 @@
 #include "Mode.hpp"
 #include "FlyLevel.hpp"
 #include "DrawLines.hpp"
+#include "SphereSim.hpp"
+#include "CollisionStats.hpp"
+#include "CollisionTrace.hpp"
 
 #include <memory>
 
@@ -14,12 +17,11 @@ struct FlyMode : Mode {
 	virtual void update(float elapsed) override;
 	virtual void draw(glm::uvec2 const &drawable_size) override;
 
-	//The (starting shape of the) level:
-	FlyLevel const &start;
-
 	//The (active, being-played) level:
 	void restart();
 	FlyLevel level;
+	//(level's changeable state as it started; restart() puts it back)
+	FlyLevel::Snapshot level_start;
 	bool won = false;
 
 	int goalsHit = 0;
@@ -31,6 +33,9 @@ struct FlyMode : Mode {
 	float time_run = 0.0f;
 	float time_record = 0.0f;
 
+	//trigger enter/exit events from the latest update (kept to reuse storage):
+	std::vector< Triggers::Event > trigger_events;
+
 	//Current control signals:
 	struct {
 		bool forward = false;
@@ -43,6 +48,22 @@ struct FlyMode : Mode {
 	bool DEBUG_fly = false;
 	bool DEBUG_show_geometry = false;
 	bool DEBUG_show_collision = false;
+	bool DEBUG_use_distance_field = false; //collide with distance field instead of triangles (to compare)
+
+	//collision work reused between frames (and its counters):
+	CollisionWorld::SlideCache slide_cache;
+
+	//stress test: loose spheres dropped with the '4' key (cleared on restart):
+	SphereSim debris;
+	void drop_debris();
+
+	//collision queries recorded while tracing (toggled with the '5' key; saved to collision-trace.bin when stopped):
+	std::unique_ptr< CollisionTrace > trace;
+	void toggle_trace();
+
+	//collision cost per collider, drawn as a heatmap while counting (toggled with the '6' key; '7' saves collision-stats.csv):
+	std::unique_ptr< CollisionStats > stats;
+	void save_stats();
 
 	//some debug drawing done during update:
 	std::unique_ptr< DrawLines > DEBUG_draw_lines;
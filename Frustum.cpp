@@ -0,0 +1,46 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+
+Frustum::Frustum(glm::mat4 const &world_to_clip) {
+	//rows of the matrix (glm stores columns):
+	glm::vec4 row[4];
+	for (uint32_t r = 0; r < 4; ++r) {
+		row[r] = glm::vec4(world_to_clip[0][r], world_to_clip[1][r], world_to_clip[2][r], world_to_clip[3][r]);
+	}
+	//e.g., the clip-space point is right of the left plane when x >= -w, i.e., (row[3] + row[0]) . pt >= 0:
+	planes[0] = row[3] + row[0];
+	planes[1] = row[3] - row[0];
+	planes[2] = row[3] + row[1];
+	planes[3] = row[3] - row[1];
+	planes[4] = row[3] + row[2];
+	planes[5] = row[3] - row[2];
+}
+
+bool Frustum::overlaps_box(glm::mat4 const &local_to_world, glm::vec3 const &min, glm::vec3 const &max) const {
+	//box as a world-space center plus three half-axes:
+	glm::vec3 center = glm::vec3(local_to_world * glm::vec4(0.5f * (min + max), 1.0f));
+	glm::vec3 radius = 0.5f * (max - min);
+	glm::vec3 axes[3] = {
+		glm::vec3(local_to_world[0]) * radius.x,
+		glm::vec3(local_to_world[1]) * radius.y,
+		glm::vec3(local_to_world[2]) * radius.z,
+	};
+
+	for (glm::vec4 const &plane : planes) {
+		glm::vec3 normal = glm::vec3(plane);
+		//how far (in plane units) the box reaches towards the inside of the plane:
+		float reach = std::abs(glm::dot(normal, axes[0]))
+			+ std::abs(glm::dot(normal, axes[1]))
+			+ std::abs(glm::dot(normal, axes[2]));
+		if (glm::dot(normal, center) + plane.w + reach < 0.0f) return false;
+	}
+	return true;
+}
+
+bool Frustum::contains(glm::vec3 const &pt) const {
+	for (glm::vec4 const &plane : planes) {
+		if (glm::dot(glm::vec3(plane), pt) + plane.w < 0.0f) return false;
+	}
+	return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+ * A Frustum is the six planes bounding the region a world-to-clip matrix
+ *  maps into the view volume (extracted from the matrix's rows, after
+ *  Gribb and Hartmann's "Fast Extraction of Viewing Frustum Planes").
+ *
+ * It is used to skip drawing objects that can't be seen; it needs only glm
+ *  (no GL context), so it can be checked on its own.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+struct Frustum {
+	//planes for OpenGL-style clip space (-w <= x,y,z <= w):
+	// (works with infinite far planes -- that plane just never rejects anything)
+	Frustum(glm::mat4 const &world_to_clip);
+
+	//does (local-space) box [min,max], placed in the world by 'local_to_world', possibly overlap the frustum?
+	// conservative: may answer 'true' for some boxes just outside the corners of the frustum, never 'false' for visible ones.
+	bool overlaps_box(glm::mat4 const &local_to_world, glm::vec3 const &min, glm::vec3 const &max) const;
+
+	//does world-space point 'pt' lie inside (or on) every plane?
+	bool contains(glm::vec3 const &pt) const;
+
+	//planes as (normal, offset), with dot(normal, pt) + offset >= 0 inside:
+	// (not normalized -- only signs are compared)
+	// order: left, right, bottom, top, near, far
+	glm::vec4 planes[6];
+};
@@ -9,11 +9,12 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <map>
+#include <tuple>
 #include <cstddef>
+#include <cstring>
 
-MeshBuffer::MeshBuffer(std::string const &filename) {
-	glGenBuffers(1, &buffer);
-
+MeshData::MeshData(std::string const &filename) {
 	std::ifstream file(filename, std::ios::binary);
 
 	GLuint total = 0;
@@ -27,14 +28,13 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 	static_assert(sizeof(Vertex) == 3*4+3*4+4*1+2*4, "Vertex is packed.");
 	std::vector< Vertex > data;
 
-	//read + upload data chunk:
+	//read data chunk:
 	if (filename.size() >= 5 && filename.substr(filename.size()-5) == ".pnct") {
 		read_chunk(file, "pnct", &data);
 
-		//upload data:
-		glBindBuffer(GL_ARRAY_BUFFER, buffer);
-		glBufferData(GL_ARRAY_BUFFER, data.size() * sizeof(Vertex), data.data(), GL_STATIC_DRAW);
-		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		//keep packed data (for upload):
+		vertices.resize(data.size() * sizeof(Vertex));
+		if (!data.empty()) std::memcpy(vertices.data(), data.data(), vertices.size());
 
 		total = GLuint(data.size()); //store total for later checks on index
 
@@ -93,6 +93,22 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 		positions.emplace_back(v.Position);
 	}
 
+	//build per-mesh triangle hierarchies for collision detection use:
+	for (auto &m : meshes) {
+		if (m.second.type != GL_TRIANGLES) continue;
+		m.second.bvh.build(positions, m.second.start, m.second.count);
+	}
+
+	//build precomputed triangle records for collision detection use:
+	collision_triangles.reserve(positions.size() / 3);
+	for (uint32_t v = 0; v + 2 < positions.size(); v += 3) {
+		collision_triangles.emplace_back(positions[v+0], positions[v+1], positions[v+2]);
+	}
+	for (auto const &m : meshes) {
+		if (m.second.type != GL_TRIANGLES) continue;
+		share_collision_features(m.second.start / 3, (m.second.start + m.second.count) / 3);
+	}
+
 	/* //DEBUG:
 	std::cout << "File '" << filename << "' contained meshes";
 	for (auto const &m : meshes) {
@@ -104,7 +120,55 @@ MeshBuffer::MeshBuffer(std::string const &filename) {
 	*/
 }
 
-const Mesh &MeshBuffer::lookup(std::string const &name) const {
+void MeshData::share_collision_features(uint32_t begin, uint32_t end) {
+	//A vertex or edge used by several triangles that all lie in the same plane gives the same
+	// collision result no matter which of the triangles tests it, and all of those triangles reject
+	// the same sweeps before testing features. So only the first of them needs to test it:
+
+	auto coplanar = [](CollisionTriangle const &x, CollisionTriangle const &y) {
+		if ((x.features | y.features) & CollisionTriangle::Degenerate) return false;
+		return glm::dot(x.normal, y.normal) > 1.0f - 1e-6f
+			&& std::abs(x.offset - y.offset) <= 1e-5f * (1.0f + std::abs(x.offset));
+	};
+
+	typedef std::tuple< float, float, float > Key;
+	auto key = [](glm::vec3 const &p) { return Key(p.x, p.y, p.z); };
+
+	struct Use {
+		uint32_t triangle;
+		uint8_t flag;
+	};
+	std::map< Key, std::vector< Use > > vertex_uses;
+	std::map< std::pair< Key, Key >, std::vector< Use > > edge_uses;
+
+	for (uint32_t t = begin; t < end; ++t) {
+		CollisionTriangle const &tri = collision_triangles[t];
+		vertex_uses[key(tri.a)].emplace_back(Use{t, CollisionTriangle::VertexA});
+		vertex_uses[key(tri.b)].emplace_back(Use{t, CollisionTriangle::VertexB});
+		vertex_uses[key(tri.c)].emplace_back(Use{t, CollisionTriangle::VertexC});
+		auto edge_key = [&key](glm::vec3 const &x, glm::vec3 const &y) {
+			return std::minmax(key(x), key(y));
+		};
+		edge_uses[edge_key(tri.a, tri.b)].emplace_back(Use{t, CollisionTriangle::EdgeAB});
+		edge_uses[edge_key(tri.b, tri.c)].emplace_back(Use{t, CollisionTriangle::EdgeBC});
+		edge_uses[edge_key(tri.c, tri.a)].emplace_back(Use{t, CollisionTriangle::EdgeCA});
+	}
+
+	auto share = [&](std::vector< Use > const &uses) {
+		if (uses.size() < 2) return;
+		CollisionTriangle const &first = collision_triangles[uses[0].triangle];
+		for (auto const &use : uses) {
+			if (!coplanar(first, collision_triangles[use.triangle])) return;
+		}
+		for (uint32_t i = 1; i < uses.size(); ++i) {
+			collision_triangles[uses[i].triangle].features &= ~uses[i].flag;
+		}
+	};
+	for (auto const &vu : vertex_uses) share(vu.second);
+	for (auto const &eu : edge_uses) share(eu.second);
+}
+
+const Mesh &MeshData::lookup(std::string const &name) const {
 	auto f = meshes.find(name);
 	if (f == meshes.end()) {
 		throw std::runtime_error("Looking up mesh '" + name + "' that doesn't exist.");
@@ -112,6 +176,25 @@ const Mesh &MeshBuffer::lookup(std::string const &name) const {
 	return f->second;
 }
 
+MeshBuffer::MeshBuffer(std::string const &filename) : MeshData(filename) {
+	upload();
+}
+
+MeshBuffer::MeshBuffer(MeshData &&data) : MeshData(std::move(data)) {
+	upload();
+}
+
+void MeshBuffer::upload() {
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, buffer);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//the GPU has its own copy now; keep only what collision detection uses:
+	vertices.clear();
+	vertices.shrink_to_fit();
+}
+
 GLuint MeshBuffer::make_vao_for_program(GLuint program) const {
 	//create a new vertex array object:
 	GLuint vao = 0;
@@ -121,7 +204,7 @@ GLuint MeshBuffer::make_vao_for_program(GLuint program) const {
 	//Try to bind all attributes in this buffer:
 	std::set< GLuint > bound;
 	glBindBuffer(GL_ARRAY_BUFFER, buffer);
-	auto bind_attribute = [&](char const *name, MeshBuffer::Attrib const &attrib) {
+	auto bind_attribute = [&](char const *name, MeshData::Attrib const &attrib) {
 		if (attrib.size == 0) return; //don't bind empty attribs
 		GLint location = glGetAttribLocation(program, name);
 		if (location == -1) return; //can't bind missing attribs
@@ -3,13 +3,19 @@
 /*
  * In this code, "Mesh" is a range of vertices that should be sent through
  *  the OpenGL pipeline together.
- * A "MeshBuffer" holds a collection of such meshes (loaded from a file) in
- *  a single OpenGL array buffer. Individual meshes can be looked up by name
- *  using the MeshBuffer::lookup() function.
+ * A "MeshData" holds a collection of such meshes (loaded from a file) in
+ *  CPU memory: vertex data, bounds, names, and collision data. Loading one
+ *  makes no OpenGL calls, so headless tools can use it.
+ * A "MeshBuffer" is MeshData that has also been uploaded into a single
+ *  OpenGL array buffer, for drawing.
+ * Individual meshes can be looked up by name using the lookup() function.
  *
  */
 
 #include "GL.hpp"
+#include "TriangleBVH.hpp"
+#include "collide.hpp"
+
 #include <glm/glm.hpp>
 #include <map>
 #include <limits>
@@ -28,30 +34,27 @@ struct Mesh {
 	//useful for debug visualization and collision detection:
 	glm::vec3 min = glm::vec3( std::numeric_limits< float >::infinity());
 	glm::vec3 max = glm::vec3(-std::numeric_limits< float >::infinity());
+
+	//Hierarchy over the mesh's triangles (in local space, indexing MeshBuffer::positions).
+	//built when the MeshBuffer is loaded; useful for collision detection:
+	TriangleBVH bvh;
 };
 
-struct MeshBuffer {
+struct MeshData {
 	//construct from a file:
 	// note: will throw if file fails to read.
-	MeshBuffer(std::string const &filename);
+	MeshData(std::string const &filename);
 
 	//look up a particular mesh by name:
 	// note: will throw if mesh not found.
 	const Mesh &lookup(std::string const &name) const;
-	
-	//build a vertex array object that links this vbo to attributes to a program:
-	// note: will throw if program defines attributes not contained in this buffer
-	GLuint make_vao_for_program(GLuint program) const;
-
-	//This is the OpenGL vertex buffer object containing the mesh data:
-	GLuint buffer = 0;
 
 	//-- internals ---
 
 	//used by the lookup() function:
 	std::map< std::string, Mesh > meshes;
 
-	//These 'Attrib' structures describe the location of various attributes within the buffer (in exactly format wanted by glVertexAttribPointer). They are set when the file is loaded and are used by the "make_vao_for_program" call:
+	//These 'Attrib' structures describe the location of various attributes within 'vertices' (in exactly format wanted by glVertexAttribPointer). They are set when the file is loaded and are used by MeshBuffer's "make_vao_for_program" call:
 	struct Attrib {
 		GLint size = 0;
 		GLenum type = 0;
@@ -69,6 +72,38 @@ struct MeshBuffer {
 	Attrib Color;
 	Attrib TexCoord;
 
+	//packed vertex data (as stored in the file), in the layout described by the Attribs:
+	// (MeshBuffer uploads this and then frees it)
+	std::vector< uint8_t > vertices;
+
 	//local copy of vertex information: (for collision detection)
 	std::vector< glm::vec3 > positions;
+
+	//precomputed (local-space) triangle records for collision detection, one per three positions:
+	// (vertices/edges shared by coplanar triangles of the same mesh are only enabled on one of them)
+	std::vector< CollisionTriangle > collision_triangles;
+	//(helper used when loading: clears shared features for triangles [begin,end) of a mesh)
+	void share_collision_features(uint32_t begin, uint32_t end);
+};
+
+struct MeshBuffer : MeshData {
+	//construct from a file and upload to OpenGL:
+	// note: will throw if file fails to read.
+	MeshBuffer(std::string const &filename);
+
+	//upload already-loaded data to OpenGL:
+	// (e.g., data loaded before there was a GL context)
+	MeshBuffer(MeshData &&data);
+
+	//build a vertex array object that links this vbo to attributes to a program:
+	// note: will throw if program defines attributes not contained in this buffer
+	GLuint make_vao_for_program(GLuint program) const;
+
+	//This is the OpenGL vertex buffer object containing the mesh data:
+	GLuint buffer = 0;
+
+	//-- internals ---
+
+	//(helper used by constructors: uploads 'vertices' to 'buffer', then frees them)
+	void upload();
 };
@@ -2,16 +2,24 @@
 #include "data_path.hpp"
 #include "LitColorTextureProgram.hpp"
 
+#include <cassert>
 #include <unordered_set>
 #include <unordered_map>
 #include <iostream>
 
 //used for lookup later:
-Mesh const *mesh_Goal = nullptr;
-Mesh const *mesh_Sphere = nullptr;
-
-//names of mesh-to-collider-mesh:
-std::unordered_map< Mesh const *, Mesh const * > mesh_to_collider;
+// (static, since FlyLevel.cpp has its own of each)
+static Mesh const *mesh_Goal = nullptr;
+static Mesh const *mesh_Sphere = nullptr;
+
+//what each mesh collides as -- either a (simpler) mesh or an analytic shape:
+struct ColliderShape {
+	ColliderShape(Mesh const *mesh_) : mesh(mesh_) { }
+	ColliderShape(CollisionPrimitive const &primitive_) : primitive(primitive_) { }
+	Mesh const *mesh = nullptr; //(nullptr for a primitive)
+	CollisionPrimitive primitive;
+};
+static std::unordered_map< Mesh const *, ColliderShape > mesh_to_collider;
 
 GLuint roll_meshes_for_lit_color_texture_program = 0;
 
@@ -26,9 +34,10 @@ Load< MeshBuffer > roll_meshes(LoadTagDefault, []() -> MeshBuffer * {
 	mesh_Goal = &ret->lookup("Goal");
 	mesh_Sphere = &ret->lookup("Sphere");
 	
-	//these meshes collide as (simpler) boxes:
-	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Dark"), &ret->lookup("Block.Simple")));
-	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Light"), &ret->lookup("Block.Simple")));
+	//these meshes collide as boxes (with Block.Simple's bounds):
+	Mesh const &block = ret->lookup("Block.Simple");
+	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Dark"), CollisionPrimitive::box(block.min, block.max)));
+	mesh_to_collider.insert(std::make_pair(&ret->lookup("Block.Light"), CollisionPrimitive::box(block.min, block.max)));
 
 	//these meshes collide as themselves:
 	mesh_to_collider.insert(std::make_pair(&ret->lookup("Round.Quarter"), &ret->lookup("Round.Quarter")));
@@ -67,6 +76,10 @@ RollLevel::RollLevel(std::string const &scene_file) {
 		pipeline.start = mesh->start;
 		pipeline.count = mesh->count;
 
+		//bounds for frustum culling:
+		drawables.back().min = mesh->min;
+		drawables.back().max = mesh->max;
+
 
 		//associate level info with the drawable:
 		if (mesh == mesh_Sphere) {
@@ -79,7 +92,11 @@ RollLevel::RollLevel(std::string const &scene_file) {
 		} else {
 			auto f = mesh_to_collider.find(mesh);
 			if (f != mesh_to_collider.end()) {
-				mesh_colliders.emplace_back(transform, *f->second, *roll_meshes);
+				if (f->second.mesh) {
+					collision.add_mesh(transform, *f->second.mesh, *roll_meshes);
+				} else {
+					collision.add_primitive(transform, f->second.primitive);
+				}
 			} else {
 				//just decoration.
 				++decorations;
@@ -91,8 +108,11 @@ RollLevel::RollLevel(std::string const &scene_file) {
 		throw std::runtime_error("Level '" + scene_file + "' contains no Sphere (starting location).");
 	}
 
+	//bake colliders into world-space static geometry:
+	collision.bake();
+
 	std::cout << "Level '" << scene_file << "' has "
-		<< mesh_colliders.size() << " mesh colliders, "
+		<< collision.colliders.size() << " mesh colliders, "
 		<< goals.size() << " goals "
 		<< "and " << decorations << " decorations."
 		<< std::endl;
@@ -110,6 +130,15 @@ RollLevel::RollLevel(RollLevel const &other) {
 	*this = other;
 }
 RollLevel &RollLevel::operator=(RollLevel const &other) {
+	if (&other == this) return *this;
+
+	//replace (rather than add to) whatever was here before:
+	transforms.clear();
+	drawables.clear();
+	cameras.clear();
+	lamps.clear();
+	camera = nullptr;
+
 	//copy other's transforms, and remember the mapping between them and the copies:
 	std::unordered_map< Transform const *, Transform * > transform_to_transform;
 	//null transform maps to itself:
@@ -156,10 +185,8 @@ RollLevel &RollLevel::operator=(RollLevel const &other) {
 	}
 
 	//---- level-specific stuff ----
-	mesh_colliders = other.mesh_colliders;
-	for (auto &c : mesh_colliders) {
-		c.transform = transform_to_transform.at(c.transform);
-	}
+	collision = other.collision;
+	collision.remap_transforms(transform_to_transform);
 
 	goals = other.goals;
 	for (auto &g : goals) {
@@ -172,3 +199,17 @@ RollLevel &RollLevel::operator=(RollLevel const &other) {
 	return *this;
 }
 
+void RollLevel::save(Snapshot *snapshot) const {
+	assert(snapshot);
+	Scene::save(&snapshot->scene);
+	snapshot->goals = goals;
+	snapshot->player = player;
+	collision.save(&snapshot->collision);
+}
+
+void RollLevel::restore(Snapshot const &snapshot) {
+	Scene::restore(snapshot.scene);
+	goals = snapshot.goals;
+	player = snapshot.player;
+	collision.restore(snapshot.collision);
+}
@@ -8,6 +8,9 @@
 #include "Scene.hpp"
 #include "Mesh.hpp"
 #include "Load.hpp"
+#include "CollisionWorld.hpp"
+
+#include <memory>
 
 struct RollLevel;
 
@@ -27,14 +30,6 @@ struct RollLevel : Scene {
 	// copy constructor actually just uses this = operator:
 	RollLevel &operator=(RollLevel const &);
 
-	
-	//Solid parts of level are tracked as MeshColliders:
-	struct MeshCollider {
-		MeshCollider(Scene::Transform *transform_, Mesh const &mesh_, MeshBuffer const &buffer_) : transform(transform_), mesh(&mesh_), buffer(&buffer_) { }
-		Scene::Transform *transform;
-		Mesh const *mesh;
-		MeshBuffer const *buffer;
-	};
 
 	//Goal objects(s) tracked using this structure:
 	struct Goal {
@@ -54,10 +49,23 @@ struct RollLevel : Scene {
 	};
 
 	//Additional information for things in the level:
-	std::vector< MeshCollider > mesh_colliders;
 	std::vector< Goal > goals;
 	Player player;
 
+	//Solid parts of level as mesh colliders:
+	CollisionWorld collision;
+
+	//Everything that changes during play, for restarting without copying the whole level again:
+	struct Snapshot {
+		Scene::Snapshot scene;
+		std::vector< Goal > goals;
+		Player player;
+		CollisionWorld::Snapshot collision;
+	};
+	void save(Snapshot *snapshot) const;
+	//(objects added since the snapshot was saved -- e.g., debris -- are removed)
+	void restore(Snapshot const &snapshot);
+
 	Scene::Camera *camera = nullptr;
 };
 
@@ -6,7 +6,7 @@
 #include "DrawSprites.hpp"
 #include "data_path.hpp"
 #include "Sound.hpp"
-#include "collide.hpp"
+#include "CollisionWorld.hpp"
 #include "gl_errors.hpp"
 
 //for glm::pow(quaternion, float):
@@ -20,6 +20,7 @@ Load< SpriteAtlas > trade_font_atlas(LoadTagDefault, []() -> SpriteAtlas const *
 });
 
 RollMode::RollMode(RollLevel const &level_) : start(level_), level(level_) {
+	level.save(&level_start);
 	restart();
 }
 
@@ -144,159 +145,83 @@ void RollMode::update(float elapsed) {
 
 		rotational_velocity *= std::pow(0.5f, elapsed / 2.0f);
 
-		if (DEBUG_fly) {
-			//DEBUG: fly mode -- no gravity:
-			velocity = glm::mix(shove, velocity, std::pow(0.5f, elapsed / 0.25f));
-		} else {
-			velocity = glm::vec3(
-				//decay existing velocity toward shove:
-				glm::mix(glm::vec2(shove), glm::vec2(velocity), std::pow(0.5f, elapsed / 0.25f)),
-				//also: gravity
-				velocity.z - 10.0f * elapsed
-			);
+		//wake up on input or if the contact plane moved out from under the player:
+		if (rest.asleep) {
+			CollisionWorld::Collider const &support = level.collision.colliders[rest.support];
+			glm::vec3 normal = glm::normalize(glm::transpose(glm::mat3(support.to_local)) * rest.local_normal);
+			glm::vec3 at = support.to_world * glm::vec4(rest.local_at, 1.0f);
+			bool plane_moved = glm::dot(normal, rest.plane_normal) < 1.0f - RestPlaneTolerance
+				|| std::abs(glm::dot(rest.plane_normal, at) - rest.plane_offset) > RestPlaneTolerance;
+			if (shove != glm::vec3(0.0f) || DEBUG_fly || plane_moved) {
+				rest.asleep = false;
+				rest.still = 0.0f;
+			}
 		}
 
-		//set up a new draw_lines object for DEBUG drawing:
-		if (!DEBUG_draw_lines) {
-			DEBUG_draw_lines.reset(new DrawLines(glm::mat4(1.0f)));
-		}
-		
-		//collide against level:
-		float remain = elapsed;
-		for (int32_t iter = 0; iter < 10; ++iter) {
-			if (remain == 0.0f) break;
+		if (rest.asleep) {
+			rest.frames_skipped += 1;
+		} else {
+			if (DEBUG_fly) {
+				//DEBUG: fly mode -- no gravity:
+				velocity = glm::mix(shove, velocity, std::pow(0.5f, elapsed / 0.25f));
+			} else {
+				velocity = glm::vec3(
+					//decay existing velocity toward shove:
+					glm::mix(glm::vec2(shove), glm::vec2(velocity), std::pow(0.5f, elapsed / 0.25f)),
+					//also: gravity
+					velocity.z - 10.0f * elapsed
+				);
+			}
 
+			//set up a new draw_lines object for DEBUG drawing:
+			if (!DEBUG_draw_lines) {
+				DEBUG_draw_lines.reset(new DrawLines(glm::mat4(1.0f)));
+			}
+		
+			//collide against level:
 			float sphere_radius = 1.0f; //player sphere is radius-1
-			glm::vec3 sphere_sweep_from = position;
-			glm::vec3 sphere_sweep_to = position + velocity * remain;
-
-			glm::vec3 sphere_sweep_min = glm::min(sphere_sweep_from, sphere_sweep_to) - glm::vec3(sphere_radius);
-			glm::vec3 sphere_sweep_max = glm::max(sphere_sweep_from, sphere_sweep_to) + glm::vec3(sphere_radius);
-
-			bool collided = false;
-			float collision_t = 1.0f;
-			glm::vec3 collision_at = glm::vec3(0.0f);
-			glm::vec3 collision_out = glm::vec3(0.0f);
-			for (auto const &collider : level.mesh_colliders) {
-				glm::mat4x3 collider_to_world = collider.transform->make_local_to_world();
-
-				{ //Early discard:
-					// check if AABB of collider overlaps AABB of swept sphere:
-
-					//(1) compute bounding box of collider in world space:
-					glm::vec3 local_center = 0.5f * (collider.mesh->max + collider.mesh->min);
-					glm::vec3 local_radius = 0.5f * (collider.mesh->max - collider.mesh->min);
-
-					glm::vec3 world_min = collider_to_world * glm::vec4(local_center, 1.0f)
-						- glm::abs(local_radius.x * collider_to_world[0])
-						- glm::abs(local_radius.y * collider_to_world[1])
-						- glm::abs(local_radius.z * collider_to_world[2]);
-					glm::vec3 world_max = collider_to_world * glm::vec4(local_center, 1.0f)
-						+ glm::abs(local_radius.x * collider_to_world[0])
-						+ glm::abs(local_radius.y * collider_to_world[1])
-						+ glm::abs(local_radius.z * collider_to_world[2]);
-
-					//(2) check if bounding boxes overlap:
-					bool can_skip = !collide_AABB_vs_AABB(sphere_sweep_min, sphere_sweep_max, world_min, world_max);
-
-					//draw to indicate result of check:
-					if (iter == 0 && DEBUG_draw_lines && DEBUG_show_geometry) {
-						DEBUG_draw_lines->draw_box(glm::mat4x3(
-							0.5f * (world_max.x - world_min.x), 0.0f, 0.0f,
-							0.0f, 0.5f * (world_max.y - world_min.y), 0.0f,
-							0.0f, 0.0f, 0.5f * (world_max.z - world_min.z),
-							0.5f * (world_max.x+world_min.x), 0.5f * (world_max.y+world_min.y), 0.5f * (world_max.z+world_min.z)
-						), (can_skip ? glm::u8vec4(0x88, 0x88, 0x88, 0xff) : glm::u8vec4(0x88, 0x88, 0x00, 0xff) ) );
+			CollisionWorld::DebugDraw debug;
+			debug.lines = DEBUG_draw_lines.get();
+			debug.show_geometry = DEBUG_show_geometry;
+			debug.show_collision = DEBUG_show_collision;
+
+			bool supported = false;
+			level.collision.slide_sphere(&position, &velocity, sphere_radius, elapsed,
+				[&](CollisionWorld::Hit const &hit, glm::vec3 const &at, glm::vec3 *velocity_) {
+					if (hit.out.z > SupportSlope) {
+						supported = true;
+						rest.support = hit.collider;
+						rest.support_at = hit.at;
+						rest.support_out = hit.out;
 					}
-
-					if (can_skip) {
-						//AABBs do not overlap; skip detailed check:
-						continue;
+					glm::vec3 &velocity = *velocity_;
+					float d = glm::dot(velocity, hit.out);
+					if (d < 0.0f) {
+						velocity -= (1.1f * d) * hit.out;
+
+						//update rotational velocity to reflect relative motion:
+						glm::vec3 slip = glm::cross(rotational_velocity, hit.at - at) + velocity;
+						glm::vec3 change = glm::cross(slip, hit.at - at);
+						rotational_velocity += change;
 					}
+				},
+				CollisionWorld::LayerSolid, &debug, 10, &slide_cache);
+
+			//fall asleep after staying slow on a floor for a bit (with no input):
+			// (a resting player still bounces off the floor a tiny bit each frame, so "slow" can't be "stopped")
+			if (supported && shove == glm::vec3(0.0f) && !DEBUG_fly && glm::length(velocity) < RestSpeed) {
+				rest.still += elapsed;
+				if (rest.still > RestDelay) {
+					rest.asleep = true;
+					CollisionWorld::Collider const &support = level.collision.colliders[rest.support];
+					rest.plane_normal = rest.support_out;
+					rest.plane_offset = glm::dot(rest.support_out, rest.support_at);
+					rest.local_at = support.to_local * glm::vec4(rest.support_at, 1.0f);
+					rest.local_normal = glm::transpose(glm::mat3(support.to_world)) * rest.support_out;
+					velocity = glm::vec3(0.0f);
 				}
-
-				//Full (all triangles) test:
-				assert(collider.mesh->type == GL_TRIANGLES); //only have code for TRIANGLES not other primitive types
-				for (GLuint v = 0; v + 2 < collider.mesh->count; v += 3) {
-					//get vertex positions from associated positions buffer:
-					//  (and transform to world space)
-					glm::vec3 a = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+0], 1.0f);
-					glm::vec3 b = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+1], 1.0f);
-					glm::vec3 c = collider_to_world * glm::vec4(collider.buffer->positions[collider.mesh->start+v+2], 1.0f);
-					//check triangle:
-					bool did_collide = collide_swept_sphere_vs_triangle(
-						sphere_sweep_from, sphere_sweep_to, sphere_radius,
-						a,b,c,
-						&collision_t, &collision_at, &collision_out);
-
-					if (did_collide) {
-						collided = true;
-					}
-
-					//draw to indicate result of check:
-					if (iter == 0 && DEBUG_draw_lines) {
-						glm::u8vec4 color = (did_collide ? glm::u8vec4(0x88, 0x00, 0x00, 0xff) : glm::u8vec4(0x88, 0x88, 0x00, 0xff));
-						if (DEBUG_show_geometry || (did_collide && DEBUG_show_collision)) {
-							DEBUG_draw_lines->draw(a,b,color);
-							DEBUG_draw_lines->draw(b,c,color);
-							DEBUG_draw_lines->draw(c,a,color);
-						}
-						//do a bit more to highlight colliding triangles (otherwise edges can be over-drawn by non-colliding triangles):
-						if (did_collide && DEBUG_show_collision) {
-							glm::vec3 m = (a + b + c) / 3.0f;
-							DEBUG_draw_lines->draw(glm::mix(a,m,0.1f),glm::mix(b,m,0.1f),color);
-							DEBUG_draw_lines->draw(glm::mix(b,m,0.1f),glm::mix(c,m,0.1f),color);
-							DEBUG_draw_lines->draw(glm::mix(c,m,0.1f),glm::mix(a,m,0.1f),color);
-						}
-					}
-				}
-			}
-
-			if (!collided) {
-				position = sphere_sweep_to;
-				remain = 0.0f;
-				break;
 			} else {
-				position = glm::mix(sphere_sweep_from, sphere_sweep_to, collision_t);
-				float d = glm::dot(velocity, collision_out);
-				if (d < 0.0f) {
-					velocity -= (1.1f * d) * collision_out;
-
-					//update rotational velocity to reflect relative motion:
-					glm::vec3 slip = glm::cross(rotational_velocity, collision_at - position) + velocity;
-					//DEBUG: std::cout << "slip: " << slip.x << " " << slip.y << " " << slip.z << std::endl;
-					/*if (DEBUG_draw_lines) {
-						DEBUG_draw_lines->draw(collision_at, collision_at + slip, glm::u8vec4(0x00, 0xff, 0x00, 0xff));
-					}*/
-					glm::vec3 change = glm::cross(slip, collision_at - position);
-					rotational_velocity += change;
-				}
-				if (DEBUG_draw_lines && DEBUG_show_collision) {
-					//draw a little gadget at the collision point:
-					glm::vec3 p1;
-					if (std::abs(collision_out.x) <= std::abs(collision_out.y) && std::abs(collision_out.x) <= std::abs(collision_out.z)) {
-						p1 = glm::vec3(1.0f, 0.0f, 0.0f);
-					} else if (std::abs(collision_out.y) <= std::abs(collision_out.z)) {
-						p1 = glm::vec3(0.0f, 1.0f, 0.0f);
-					} else {
-						p1 = glm::vec3(0.0f, 0.0f, 1.0f);
-					}
-					p1 = glm::normalize(p1 - glm::dot(p1, collision_out)*collision_out);
-					glm::vec3 p2 = glm::cross(collision_out, p1);
-
-					float r = 0.25f;
-					glm::u8vec4 color = glm::u8vec4(0xff, 0x00, 0x00, 0xff);
-					DEBUG_draw_lines->draw(collision_at + r*p1, collision_at + r*p2, color);
-					DEBUG_draw_lines->draw(collision_at + r*p2, collision_at - r*p1, color);
-					DEBUG_draw_lines->draw(collision_at - r*p1, collision_at - r*p2, color);
-					DEBUG_draw_lines->draw(collision_at - r*p2, collision_at + r*p1, color);
-					DEBUG_draw_lines->draw(collision_at, collision_at + collision_out, color);
-				}
-				/*if (iter == 0) {
-					std::cout << collision_out.x << ", " << collision_out.y << ", " << collision_out.z
-					<< " / " << velocity.x << ", " << velocity.y << ", " << velocity.z << std::endl; //DEBUG
-				}*/
-				remain = (1.0f - collision_t) * remain;
+				rest.still = 0.0f;
 			}
 		}
 
@@ -327,6 +252,14 @@ void RollMode::update(float elapsed) {
 		;
 		glm::vec3 in = level.camera->transform->rotation * glm::vec3(0.0f, 0.0f, -1.0f);
 		level.camera->transform->position = level.player.transform->position - 10.0f * in;
+
+		//pull camera in front of any level geometry between it and the player:
+		glm::vec3 const &target = level.player.transform->position;
+		glm::vec3 &camera_position = level.camera->transform->position;
+		CollisionWorld::Hit hit;
+		if (level.collision.raycast(target, camera_position, &hit)) {
+			camera_position = hit.at + 0.2f * hit.out;
+		}
 	}
 }
 
@@ -388,6 +321,9 @@ void RollMode::draw(glm::uvec2 const &drawable_size) {
 }
 
 void RollMode::restart() {
-	level = start;
+	//(cheaper than 'level = start', which copies and re-links every transform)
+	level.restore(level_start);
 	won = false;
+	rest.asleep = false;
+	rest.still = 0.0f;
 }
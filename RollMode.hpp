@@ -20,6 +20,8 @@ struct RollMode : Mode {
 	//The (active, being-played) level:
 	void restart();
 	RollLevel level;
+	//(level's changeable state as copied from start; restart() puts it back)
+	RollLevel::Snapshot level_start;
 	bool won = false;
 
 	//Current control signals:
@@ -35,6 +37,30 @@ struct RollMode : Mode {
 	bool DEBUG_show_geometry = false;
 	bool DEBUG_show_collision = false;
 
+	//collision work reused between frames (and its counters):
+	CollisionWorld::SlideCache slide_cache;
+
+	//A player resting on a floor with no input is put to sleep, which skips its collision entirely:
+	// (woken by input, or if the contact plane it rests on moves -- e.g., collider_moved() on its support)
+	struct {
+		bool asleep = false;
+		float still = 0.0f; //seconds spent slow and supported (falls asleep after RestDelay)
+		uint32_t support = -1U; //collider last supporting the player
+		glm::vec3 support_at = glm::vec3(0.0f); //last contact point on the support (world space)
+		glm::vec3 support_out = glm::vec3(0.0f, 0.0f, 1.0f); //last contact normal on the support (world space)
+		//contact plane when the player fell asleep (world space):
+		glm::vec3 plane_normal = glm::vec3(0.0f, 0.0f, 1.0f);
+		float plane_offset = 0.0f;
+		//the same contact, in the support's local space (so the plane can be found again after the support moves):
+		glm::vec3 local_at = glm::vec3(0.0f);
+		glm::vec3 local_normal = glm::vec3(0.0f, 0.0f, 1.0f);
+		uint64_t frames_skipped = 0; //(counter) frames where collision was skipped
+	} rest;
+	static constexpr float RestSpeed = 0.1f; //players slower than this (units/s) count as still
+	static constexpr float RestDelay = 0.5f;
+	static constexpr float SupportSlope = 0.7f; //contacts with out.z above this count as floors
+	static constexpr float RestPlaneTolerance = 1e-4f; //contact plane changes smaller than this don't wake the player
+
 	//some debug drawing done during update:
 	std::unique_ptr< DrawLines > DEBUG_draw_lines;
 };
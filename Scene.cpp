@@ -1,11 +1,14 @@
 #include "Scene.hpp"
+#include "Frustum.hpp"
 
 #include "gl_errors.hpp"
 #include "read_write_chunk.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
+#include <atomic>
 #include <fstream>
+#include <mutex>
 
 //-------------------------
 
@@ -46,17 +49,122 @@ glm::mat4 Scene::Transform::make_parent_to_local() const {
 }
 
 glm::mat4 Scene::Transform::make_local_to_world() const {
-	if (!parent) {
-		return make_local_to_parent();
-	} else {
-		return parent->make_local_to_world() * make_local_to_parent();
-	}
+	return cached().local_to_world;
 }
 glm::mat4 Scene::Transform::make_world_to_local() const {
-	if (!parent) {
-		return make_parent_to_local();
-	} else {
-		return make_parent_to_local() * parent->make_world_to_local();
+	return cached().world_to_local;
+}
+
+//frames start at 1, so a never-checked cache (frame 0) is never current:
+static std::atomic< uint64_t > current_frame(1);
+
+void Scene::Transform::next_frame() {
+	current_frame.fetch_add(1);
+}
+
+void Scene::Transform::refresh_cache() const {
+	update_cache(true);
+}
+
+Scene::Transform::Cache::Built const &Scene::Transform::cached() const {
+	if (cache.frame.load(std::memory_order_acquire) == current_frame.load(std::memory_order_acquire)) {
+		Cache::Built const &b = cache.built[cache.current.load(std::memory_order_acquire)];
+		if (b.position == position && b.rotation == rotation && b.scale == scale && b.parent == parent) return b;
+	}
+	update_cache(false);
+	return cache.built[cache.current.load(std::memory_order_acquire)];
+}
+
+void Scene::Transform::update_cache(bool every_ancestor) const {
+	uint64_t frame = current_frame.load(std::memory_order_acquire);
+
+	//(stamps are never reused, so a child can't mistake a new parent -- even one at the same address -- for its old one)
+	static std::atomic< uint64_t > next_stamp(1);
+	//caches are rebuilt under one of a few locks, picked by address, so threads looking up the same transform don't collide:
+	static std::mutex locks[64];
+
+	//collect this transform and any ancestors not yet checked this frame, nearest first:
+	// (in a list rather than by recursion, so very deep hierarchies can't overflow the stack;
+	//  most hierarchies are shallow, so the first few entries don't allocate)
+	enum : uint32_t { InlineStale = 16 };
+	Transform const *stale_inline[InlineStale];
+	std::vector< Transform const * > stale_rest;
+	uint32_t stale_count = 0;
+	for (Transform const *t = this; t; t = t->parent) {
+		if (t != this && !every_ancestor && t->cache.frame.load(std::memory_order_acquire) == frame) break;
+		if (stale_count < InlineStale) stale_inline[stale_count] = t;
+		else stale_rest.emplace_back(t);
+		++stale_count;
+	}
+
+	//check them from the root down, so each parent is up to date before its child looks at it:
+	for (uint32_t i = stale_count; i-- > 0; ) {
+		Transform const &t = *(i < InlineStale ? stale_inline[i] : stale_rest[i - InlineStale]);
+		Cache &c = t.cache;
+		std::lock_guard< std::mutex > lock(locks[(reinterpret_cast< uintptr_t >(&t) / sizeof(Transform)) % 64]);
+
+		uint32_t current = c.current.load(std::memory_order_relaxed);
+		Cache::Built const &old = c.built[current];
+		uint64_t parent_stamp = (t.parent ? t.parent->cache.built[t.parent->cache.current.load(std::memory_order_acquire)].stamp : 0);
+		if (old.stamp == 0
+		 || old.position != t.position || old.rotation != t.rotation || old.scale != t.scale
+		 || old.parent != t.parent || old.parent_stamp != parent_stamp) {
+			Cache::Built &b = c.built[1 - current];
+			b.position = t.position;
+			b.rotation = t.rotation;
+			b.scale = t.scale;
+			b.parent = t.parent;
+			b.parent_stamp = parent_stamp;
+			b.stamp = next_stamp.fetch_add(1, std::memory_order_relaxed);
+			if (!t.parent) {
+				b.local_to_world = t.make_local_to_parent();
+				b.world_to_local = t.make_parent_to_local();
+			} else {
+				Cache::Built const &p = t.parent->cache.built[t.parent->cache.current.load(std::memory_order_acquire)];
+				b.local_to_world = p.local_to_world * t.make_local_to_parent();
+				b.world_to_local = t.make_parent_to_local() * p.world_to_local;
+			}
+			c.current.store(1 - current, std::memory_order_release);
+		}
+		c.frame.store(frame, std::memory_order_release);
+	}
+}
+
+//-------------------------
+
+void Scene::save(Snapshot *snapshot_) const {
+	assert(snapshot_);
+	Snapshot &snapshot = *snapshot_;
+	snapshot.transforms.clear();
+	snapshot.transforms.reserve(transforms.size());
+	for (auto const &t : transforms) {
+		snapshot.transforms.emplace_back(Snapshot::TransformState{t.position, t.rotation, t.scale, t.parent});
+	}
+	snapshot.drawables = drawables.size();
+	snapshot.cameras = cameras.size();
+	snapshot.lamps = lamps.size();
+}
+
+void Scene::restore(Snapshot const &snapshot) {
+	assert(transforms.size() >= snapshot.transforms.size());
+	assert(drawables.size() >= snapshot.drawables);
+	assert(cameras.size() >= snapshot.cameras);
+	assert(lamps.size() >= snapshot.lamps);
+
+	//objects added since (which refer to transforms) go first:
+	while (drawables.size() > snapshot.drawables) drawables.pop_back();
+	while (cameras.size() > snapshot.cameras) cameras.pop_back();
+	while (lamps.size() > snapshot.lamps) lamps.pop_back();
+	while (transforms.size() > snapshot.transforms.size()) transforms.pop_back();
+
+	auto state = snapshot.transforms.begin();
+	for (auto &t : transforms) {
+		t.position = state->position;
+		t.rotation = state->rotation;
+		t.scale = state->scale;
+		t.parent = state->parent;
+		t.cache.frame.store(0, std::memory_order_relaxed); //(so the restored state shows up without waiting for the next frame)
+		++state;
 	}
 }
 
@@ -76,6 +184,8 @@ void Scene::draw(Camera const &camera) const {
 }
 
 void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_light) const {
+	Frustum frustum(world_to_clip);
+	draw_counts = DrawCounts();
 
 	//Iterate through all drawables, sending each one to OpenGL:
 	for (auto const &drawable : drawables) {
@@ -87,6 +197,19 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_lig
 		//skip any drawables that don't contain any vertices:
 		if (pipeline.count == 0) continue;
 
+		//the object-to-world matrix is used for culling and in all three of the uniforms below:
+		assert(drawable.transform); //drawables *must* have a transform
+		glm::mat4 object_to_world = drawable.transform->make_local_to_world();
+
+		//skip any drawables that are outside the view:
+		if (drawable.min.x <= drawable.max.x) {
+			draw_counts.tested += 1;
+			if (!frustum.overlaps_box(object_to_world, drawable.min, drawable.max)) {
+				draw_counts.culled += 1;
+				continue;
+			}
+		}
+		draw_counts.drawn += 1;
 
 		//Set shader program:
 		glUseProgram(pipeline.program);
@@ -96,10 +219,6 @@ void Scene::draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_lig
 
 		//Configure program uniforms:
 
-		//the object-to-world matrix is used in all three of these uniforms:
-		assert(drawable.transform); //drawables *must* have a transform
-		glm::mat4 object_to_world = drawable.transform->make_local_to_world();
-
 		//OBJECT_TO_CLIP takes vertices from object space to clip space:
 		if (pipeline.OBJECT_TO_CLIP_mat4 != -1U) {
 			glm::mat4 object_to_clip = world_to_clip * object_to_world;
@@ -17,11 +17,13 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
 
+#include <atomic>
 #include <list>
 #include <memory>
 #include <functional>
 #include <string>
 #include <vector>
+#include <limits>
 
 struct Scene {
 	struct Transform {
@@ -41,6 +43,9 @@ struct Scene {
 		glm::mat4 make_local_to_parent() const;
 		glm::mat4 make_parent_to_local() const;
 		// ..relative to the world:
+		// (these are cached; changes to this transform show up right away, but changes to its ancestors
+		//  are only checked for once per frame -- see next_frame() -- unless refresh_cache() is called.
+		//  Looking up transforms from several threads at once is fine, as long as none is changed meanwhile.)
 		glm::mat4 make_local_to_world() const;
 		glm::mat4 make_world_to_local() const;
 
@@ -48,6 +53,39 @@ struct Scene {
 		Transform(Transform const &) = delete;
 		//if we delete some constructors, we need to let the compiler know that the default constructor is still okay:
 		Transform() = default;
+
+		//Start a new frame; ancestors of transforms looked up after this are checked (once) against their current values:
+		// (main.cpp, show-meshes.cpp, and show-scene.cpp call this at the top of every pass through their loops)
+		static void next_frame();
+
+		//Bring the cached world matrices up to date now, checking every ancestor even if it was already checked this frame:
+		// (for code that needs an ancestor's change before the next frame, e.g. CollisionWorld::collider_moved)
+		void refresh_cache() const;
+
+		//Cached world matrices, along with the values they were built from:
+		// (position, rotation, scale, and parent are set directly all over the code, so rather than
+		//  tracking changes, the cache is checked against them on lookup -- ancestors at most once per frame)
+		struct Cache {
+			std::atomic< uint64_t > frame{0}; //frame ancestors were last checked in; 0 if never
+			//matrices are built into the slot not being read, then 'current' is switched over,
+			// so threads looking up the same transform never read a slot while it is written:
+			struct Built {
+				glm::vec3 position = glm::vec3(0.0f);
+				glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+				glm::vec3 scale = glm::vec3(0.0f);
+				Transform const *parent = nullptr;
+				uint64_t parent_stamp = 0; //parent's stamp when this was built
+				uint64_t stamp = 0; //unique per rebuild (so children can tell the parent changed); 0 if never built
+				glm::mat4 local_to_world = glm::mat4(1.0f);
+				glm::mat4 world_to_local = glm::mat4(1.0f);
+			} built[2];
+			std::atomic< uint32_t > current{0};
+		};
+		mutable Cache cache;
+		//cached matrices, checked against this transform's values (and, once per frame, its ancestors'):
+		Cache::Built const &cached() const;
+		//bring this transform's cache (and its ancestors' caches, if stale or 'every_ancestor') up to date:
+		void update_cache(bool every_ancestor) const;
 	};
 
 	struct Drawable {
@@ -55,6 +93,12 @@ struct Scene {
 		Drawable(Transform *transform_) : transform(transform_) { assert(transform); }
 		Transform * transform;
 
+		//Bounding box of the drawn vertices, in transform's local space (e.g., the Mesh's min and max):
+		// used to skip drawables outside the view frustum;
+		// left empty (min > max), the drawable is never skipped.
+		glm::vec3 min = glm::vec3( std::numeric_limits< float >::infinity());
+		glm::vec3 max = glm::vec3(-std::numeric_limits< float >::infinity());
+
 		//Contains all the data needed to run the OpenGL pipeline:
 		struct Pipeline {
 			GLuint program = 0; //shader program; passed to glUseProgram
@@ -127,6 +171,34 @@ struct Scene {
 	//..sometimes, you want to draw with a custom projection matrix and/or light space:
 	void draw(glm::mat4 const &world_to_clip, glm::mat4x3 const &world_to_light = glm::mat4x3(1.0f)) const;
 
+	//What the most recent draw() call did with the drawables (that had a program and vertices):
+	struct DrawCounts {
+		uint32_t tested = 0; //bounds checked against the view frustum
+		uint32_t culled = 0; //skipped as outside the frustum
+		uint32_t drawn = 0; //sent to OpenGL (including any without bounds)
+	};
+	mutable DrawCounts draw_counts;
+
+	//The changeable state of a scene -- transformations, and how many of each object there are -- for cheap restores:
+	// (e.g., to restart a level without copying it again)
+	struct Snapshot {
+		struct TransformState {
+			glm::vec3 position;
+			glm::quat rotation;
+			glm::vec3 scale;
+			Transform *parent;
+		};
+		std::vector< TransformState > transforms; //in the same order as Scene::transforms
+		size_t drawables = 0;
+		size_t cameras = 0;
+		size_t lamps = 0;
+	};
+	void save(Snapshot *snapshot) const;
+	//put transforms back as saved, and remove anything added to the ends of the lists since:
+	// (the scene must not have lost anything since the snapshot was saved)
+	// (doesn't allocate, once 'snapshot' has been saved into)
+	void restore(Snapshot const &snapshot);
+
 	//add transforms/objects/cameras from a scene file to this scene:
 	// the 'on_drawable' callback gives your code a chance to look up mesh data and make Drawables:
 	// throws on file format errors
@@ -0,0 +1,129 @@
+#include "SphereSim.hpp"
+
+#include <glm/gtx/quaternion.hpp>
+
+#include <algorithm>
+#include <cassert>
+
+//grid cell keys (as in ColliderGrid: 21 bits per axis):
+static glm::ivec3 cell_of(glm::vec3 const &pt, float cell_size) {
+	glm::vec3 c = glm::clamp(glm::floor(pt / cell_size), glm::vec3(-1048576.0f), glm::vec3(1048575.0f));
+	return glm::ivec3(c);
+}
+
+static uint64_t key_of(glm::ivec3 const &cell) {
+	return (uint64_t(uint32_t(cell.x) & 0x1fffff))
+	     | (uint64_t(uint32_t(cell.y) & 0x1fffff) << 21)
+	     | (uint64_t(uint32_t(cell.z) & 0x1fffff) << 42);
+}
+
+void SphereSim::step(CollisionWorld const &world, float elapsed) {
+	uint32_t count = uint32_t(spheres.size());
+	slid_position.resize(count);
+	slid_velocity.resize(count);
+
+	if (!pool || pool_threads != threads) {
+		pool.reset(new WorkerPool(threads));
+		pool_threads = threads;
+	}
+	//(not worth waking a thread for just a few spheres)
+	uint32_t const MinRange = 64;
+
+	//(1) move each sphere through the level on its own:
+	pool->parallel_for(count, MinRange, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++i) {
+			Sphere &sphere = spheres[i];
+			sphere.velocity += gravity * elapsed;
+			sphere.rotational_velocity *= std::pow(0.5f, elapsed / 2.0f);
+
+			world.slide_sphere(&sphere.position, &sphere.velocity, sphere.radius, elapsed,
+				[&sphere](CollisionWorld::Hit const &hit, glm::vec3 const &at, glm::vec3 *velocity_) {
+					glm::vec3 &velocity = *velocity_;
+					float d = glm::dot(velocity, hit.out);
+					if (d < 0.0f) {
+						velocity -= (1.1f * d) * hit.out;
+
+						//update rotational velocity to reflect relative motion:
+						glm::vec3 slip = glm::cross(sphere.rotational_velocity, hit.at - at) + velocity;
+						sphere.rotational_velocity += glm::cross(slip, hit.at - at) / (sphere.radius * sphere.radius);
+					}
+				},
+				CollisionWorld::LayerSolid, nullptr, 10, &sphere.slide_cache);
+
+			slid_position[i] = sphere.position;
+			slid_velocity[i] = sphere.velocity;
+		}
+	});
+
+	//sort spheres into a grid whose cells are at least as wide as any sphere:
+	// (so contacts are always with spheres in the same or an adjacent cell)
+	float max_radius = 0.0f;
+	for (auto const &sphere : spheres) {
+		max_radius = std::max(max_radius, sphere.radius);
+	}
+	cell_size = std::max(2.0f * max_radius, 1e-3f);
+	cell_spheres.clear();
+	cell_spheres.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		cell_spheres.emplace_back(key_of(cell_of(slid_position[i], cell_size)), i);
+	}
+	std::sort(cell_spheres.begin(), cell_spheres.end());
+
+	//(2) push each sphere out of the spheres it overlaps:
+	// (reads only phase (1) results, so the order spheres are handled in doesn't matter)
+	pool->parallel_for(count, MinRange, [&](uint32_t begin, uint32_t end) {
+		for (uint32_t i = begin; i < end; ++i) {
+			Sphere &sphere = spheres[i];
+			glm::vec3 const &p = slid_position[i];
+			glm::vec3 const &v = slid_velocity[i];
+			glm::vec3 dp = glm::vec3(0.0f);
+			glm::vec3 dv = glm::vec3(0.0f);
+
+			glm::ivec3 cell = cell_of(p, cell_size);
+			for (int32_t dz = -1; dz <= 1; ++dz) {
+				for (int32_t dy = -1; dy <= 1; ++dy) {
+					for (int32_t dx = -1; dx <= 1; ++dx) {
+						uint64_t key = key_of(cell + glm::ivec3(dx, dy, dz));
+						auto first = std::lower_bound(cell_spheres.begin(), cell_spheres.end(), std::make_pair(key, uint32_t(0)));
+						for (auto cs = first; cs != cell_spheres.end() && cs->first == key; ++cs) {
+							uint32_t j = cs->second;
+							if (j == i) continue;
+							Sphere const &other = spheres[j];
+
+							glm::vec3 d = p - slid_position[j];
+							float reach = sphere.radius + other.radius;
+							float dist2 = glm::dot(d, d);
+							if (dist2 >= reach * reach) continue;
+
+							//contact normal (pointing toward this sphere); coincident spheres are split by index:
+							float dist = std::sqrt(dist2);
+							glm::vec3 n = (dist > 0.0f ? d / dist : glm::vec3(i < j ? 1.0f : -1.0f, 0.0f, 0.0f));
+							//this sphere's share of the separation and of the impulse:
+							float share = other.mass / (sphere.mass + other.mass);
+
+							dp += ((reach - dist) * share) * n;
+							float approach = glm::dot(v - slid_velocity[j], n);
+							if (approach < 0.0f) {
+								dv -= ((1.0f + restitution) * approach * share) * n;
+							}
+						}
+					}
+				}
+			}
+
+			sphere.position = p + dp;
+			sphere.velocity = v + dv;
+
+			//roll:
+			float spin = glm::length(sphere.rotational_velocity);
+			if (spin > 0.0f) {
+				sphere.rotation = glm::normalize(glm::angleAxis(spin * elapsed, sphere.rotational_velocity / spin) * sphere.rotation);
+			}
+
+			if (sphere.transform) {
+				sphere.transform->position = sphere.position;
+				sphere.transform->rotation = sphere.rotation;
+			}
+		}
+	});
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+/*
+ * SphereSim moves many dynamic spheres (obstacles, debris, rollers, ...)
+ *  through a level, colliding them with the level and with each other.
+ *
+ * Each step runs in two phases, each split across worker threads:
+ *  (1) every sphere falls and slides through the CollisionWorld on its own;
+ *  (2) every sphere resolves its contacts with nearby spheres, reading only
+ *      the positions/velocities from the end of phase (1) ("Jacobi" style).
+ * A sphere's result never depends on which thread handled it or on the
+ *  order other spheres were processed, so stepping is deterministic for
+ *  any number of threads.
+ *
+ */
+
+#include "CollisionWorld.hpp"
+#include "Scene.hpp"
+#include "WorkerPool.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+struct SphereSim {
+	struct Sphere {
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::vec3 velocity = glm::vec3(0.0f);
+		float radius = 1.0f;
+		float mass = 1.0f;
+
+		//purely cosmetic rolling:
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 rotational_velocity = glm::vec3(0.0f);
+
+		//[optional] transform to copy position/rotation into after each step (e.g., for drawing):
+		Scene::Transform *transform = nullptr;
+
+		//collision work reused between steps:
+		CollisionWorld::SlideCache slide_cache;
+	};
+	std::vector< Sphere > spheres;
+
+	glm::vec3 gravity = glm::vec3(0.0f, 0.0f, -10.0f);
+	float restitution = 0.2f; //bounciness of sphere-sphere contacts
+
+	//number of threads to use (0 means one per hardware thread):
+	// (workers are started on the first step, and kept until the SphereSim is destroyed or this changes)
+	uint32_t threads = 0;
+
+	//advance all spheres by 'elapsed' seconds:
+	void step(CollisionWorld const &world, float elapsed);
+
+	//-- internals --
+
+	//(cell key, sphere index) of each sphere in the contact grid, sorted:
+	std::vector< std::pair< uint64_t, uint32_t > > cell_spheres;
+	float cell_size = 2.0f; //(at least the largest sphere diameter; set by step())
+
+	//state at end of phase (1), read by phase (2):
+	std::vector< glm::vec3 > slid_position;
+	std::vector< glm::vec3 > slid_velocity;
+
+	std::unique_ptr< WorkerPool > pool;
+	uint32_t pool_threads = 0; //value of 'threads' when 'pool' was made
+};
@@ -0,0 +1,32 @@
+#include "StaticCollision.hpp"
+
+#include <cassert>
+
+void StaticCollision::add(glm::mat4x3 const &to_world, Mesh const &mesh, MeshData const &buffer, uint32_t collider) {
+	assert(mesh.type == GL_TRIANGLES); //only have code for TRIANGLES not other primitive types
+	assert(mesh.start + mesh.count <= buffer.positions.size());
+
+	positions.reserve(positions.size() + mesh.count);
+	triangles.reserve(triangles.size() + mesh.count / 3);
+	colliders.reserve(colliders.size() + mesh.count / 3);
+
+	for (GLuint v = 0; v + 2 < mesh.count; v += 3) {
+		glm::vec3 a = to_world * glm::vec4(buffer.positions[mesh.start+v+0], 1.0f);
+		glm::vec3 b = to_world * glm::vec4(buffer.positions[mesh.start+v+1], 1.0f);
+		glm::vec3 c = to_world * glm::vec4(buffer.positions[mesh.start+v+2], 1.0f);
+		positions.emplace_back(a);
+		positions.emplace_back(b);
+		positions.emplace_back(c);
+
+		//features (vertices/edges shared with other triangles) are the same as in the source mesh:
+		uint8_t features = buffer.collision_triangles[(mesh.start+v)/3].features & CollisionTriangle::AllFeatures;
+		triangles.emplace_back(a, b, c, features);
+		colliders.emplace_back(collider);
+	}
+}
+
+void StaticCollision::build() {
+	assert(positions.size() == 3 * triangles.size());
+	assert(colliders.size() == triangles.size());
+	bvh.build(positions, 0, uint32_t(positions.size()));
+}
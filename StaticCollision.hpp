@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * StaticCollision holds level geometry that doesn't move, "baked" into
+ *  world space when the level is loaded:
+ *  - triangle vertices are stored contiguously in world space,
+ *  - each triangle has a precomputed CollisionTriangle record and a source collider,
+ *  - a TriangleBVH over all of the triangles finds candidates quickly.
+ *
+ * Once built, a StaticCollision is never modified, so it can be shared
+ *  (by std::shared_ptr) between a pristine level and its being-played copies.
+ *
+ */
+
+#include "Mesh.hpp"
+#include "TriangleBVH.hpp"
+#include "collide.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+struct StaticCollision {
+	//add all triangles of 'mesh' (from 'buffer'), transformed by 'to_world':
+	// 'collider' is stored with each triangle so callers can tell where it came from.
+	void add(glm::mat4x3 const &to_world, Mesh const &mesh, MeshData const &buffer, uint32_t collider);
+
+	//build acceleration structure (call once, after all add() calls):
+	void build();
+
+	//call 'fn(uint32_t triangle)' for each triangle that the sphere swept from 'from' to 'to' might touch:
+	// (culls with the hierarchy and with each triangle's plane)
+	template< typename F >
+	void for_each_candidate(glm::vec3 const &from, glm::vec3 const &to, float radius, F const &fn) const;
+
+	//call 'fn(uint32_t triangle)' for each triangle the segment from + s * (to - from), s in [0,*limit], might cross:
+	// (see TriangleBVH::for_each_along_segment -- 'fn' returns false to stop, and may lower *limit)
+	template< typename F >
+	void for_each_along_segment(glm::vec3 const &from, glm::vec3 const &to, float *limit, F const &fn) const;
+
+	//world-space vertices, three per triangle:
+	std::vector< glm::vec3 > positions;
+
+	//precomputed (world-space) records, one per triangle:
+	std::vector< CollisionTriangle > triangles;
+
+	//source collider (as passed to add()) of each triangle:
+	std::vector< uint32_t > colliders;
+
+	TriangleBVH bvh;
+};
+
+//---------------------------
+
+template< typename F >
+void StaticCollision::for_each_candidate(glm::vec3 const &from, glm::vec3 const &to, float radius, F const &fn) const {
+	glm::vec3 min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 max = glm::max(from, to) + glm::vec3(radius);
+
+	//plane test is padded slightly so it never rejects a triangle the exact test would accept:
+	float const limit = radius + 1e-3f;
+
+	bvh.for_each_overlapping(min, max, [&](uint32_t v) {
+		uint32_t index = v / 3;
+		CollisionTriangle const &tri = triangles[index];
+		float d_from = glm::dot(tri.normal, from) - tri.offset;
+		float d_to = glm::dot(tri.normal, to) - tri.offset;
+		if ((d_from > limit && d_to > limit) || (d_from < -limit && d_to < -limit)) return;
+		fn(index);
+	});
+}
+
+template< typename F >
+void StaticCollision::for_each_along_segment(glm::vec3 const &from, glm::vec3 const &to, float *limit, F const &fn) const {
+	bvh.for_each_along_segment(from, to, limit, [&](uint32_t v) -> bool {
+		return fn(v / 3);
+	});
+}
@@ -0,0 +1,229 @@
+#include "TransformStore.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+
+//a * b for affine matrices (i.e., as if each had a (0,0,0,1) bottom row):
+static glm::mat4x3 compose(glm::mat4x3 const &a, glm::mat4x3 const &b) {
+	glm::mat3 a3 = glm::mat3(a);
+	return glm::mat4x3(a3 * b[0], a3 * b[1], a3 * b[2], a3 * b[3] + a[3]);
+}
+
+uint32_t TransformStore::slot(Handle handle) const {
+	assert(valid(handle));
+	return slot_of[handle.index];
+}
+
+bool TransformStore::valid(Handle handle) const {
+	return handle.index < slot_of.size() && slot_of[handle.index] != -1U && generations[handle.index] == handle.generation;
+}
+
+TransformStore::Handle TransformStore::parent(Handle handle) const {
+	uint32_t p = parents[slot(handle)];
+	if (p == -1U) return Handle();
+	Handle ret;
+	ret.index = handle_of[p];
+	ret.generation = generations[ret.index];
+	return ret;
+}
+
+TransformStore::Handle TransformStore::add(Handle parent, glm::vec3 const &position, glm::quat const &rotation, glm::vec3 const &scale) {
+	Handle handle;
+	if (!free_handles.empty()) {
+		handle.index = free_handles.back();
+		free_handles.pop_back();
+	} else {
+		handle.index = uint32_t(slot_of.size());
+		slot_of.emplace_back(-1U);
+		generations.emplace_back(0);
+	}
+	handle.generation = generations[handle.index];
+
+	//parent already exists, so appending keeps parents first:
+	uint32_t s = size();
+	positions.emplace_back(position);
+	rotations.emplace_back(rotation);
+	scales.emplace_back(scale);
+	parents.emplace_back(parent == Handle() ? -1U : slot(parent));
+	local_to_worlds.emplace_back(1.0f);
+	world_to_locals.emplace_back(1.0f);
+	handle_of.emplace_back(handle.index);
+	slot_of[handle.index] = s;
+	level_starts.clear();
+
+	return handle;
+}
+
+std::vector< TransformStore::Handle > TransformStore::add_scene(Scene const &scene) {
+	std::unordered_map< Scene::Transform const *, Handle > added;
+	//(recursion is as deep as the hierarchy)
+	std::function< Handle(Scene::Transform const *) > add_transform = [&](Scene::Transform const *t) {
+		auto f = added.find(t);
+		if (f != added.end()) return f->second;
+		Handle parent = (t->parent ? add_transform(t->parent) : Handle());
+		Handle handle = add(parent, t->position, t->rotation, t->scale);
+		added.emplace(t, handle);
+		return handle;
+	};
+
+	std::vector< Handle > handles;
+	handles.reserve(scene.transforms.size());
+	for (auto const &t : scene.transforms) {
+		handles.emplace_back(add_transform(&t));
+	}
+	return handles;
+}
+
+void TransformStore::remove(Handle handle) {
+	uint32_t s = slot(handle);
+	assert(std::find(parents.begin() + s, parents.end(), s) == parents.end() && "remove children before their parent");
+
+	//shift later slots down (keeping their order):
+	auto erase = [s](auto &vec) {
+		vec.erase(vec.begin() + s);
+	};
+	erase(positions);
+	erase(rotations);
+	erase(scales);
+	erase(parents);
+	erase(local_to_worlds);
+	erase(world_to_locals);
+	erase(handle_of);
+	for (uint32_t i = s; i < size(); ++i) {
+		if (parents[i] != -1U && parents[i] > s) parents[i] -= 1;
+		slot_of[handle_of[i]] = i;
+	}
+
+	slot_of[handle.index] = -1U;
+	generations[handle.index] += 1;
+	free_handles.emplace_back(handle.index);
+	level_starts.clear();
+}
+
+void TransformStore::set_parent(Handle handle, Handle parent) {
+	uint32_t s = slot(handle);
+	level_starts.clear();
+	if (parent == Handle()) {
+		parents[s] = -1U;
+		return;
+	}
+	uint32_t p = slot(parent);
+	//(can't parent a transform to one of its descendants)
+	for (uint32_t a = p; a != -1U; a = parents[a]) {
+		assert(a != s && "set_parent would make a cycle");
+	}
+	parents[s] = p;
+	if (p > s) sort();
+}
+
+void TransformStore::sort() {
+	//depth of each slot (parents may be anywhere, so chase them):
+	std::vector< uint32_t > depth(size(), -1U);
+	std::function< uint32_t(uint32_t) > depth_of = [&](uint32_t s) -> uint32_t {
+		if (depth[s] == -1U) depth[s] = (parents[s] == -1U ? 0 : depth_of(parents[s]) + 1);
+		return depth[s];
+	};
+
+	//ordering by depth puts every parent before its children; stable, so siblings keep their order:
+	std::vector< uint32_t > order(size());
+	for (uint32_t s = 0; s < size(); ++s) {
+		order[s] = s;
+		depth_of(s);
+	}
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		return depth[a] < depth[b];
+	});
+
+	std::vector< uint32_t > new_slot(size());
+	for (uint32_t i = 0; i < size(); ++i) {
+		new_slot[order[i]] = i;
+	}
+	auto permute = [&](auto &vec) {
+		auto old = vec;
+		for (uint32_t i = 0; i < size(); ++i) {
+			vec[i] = old[order[i]];
+		}
+	};
+	permute(positions);
+	permute(rotations);
+	permute(scales);
+	permute(parents);
+	permute(local_to_worlds);
+	permute(world_to_locals);
+	permute(handle_of);
+	for (uint32_t i = 0; i < size(); ++i) {
+		if (parents[i] != -1U) parents[i] = new_slot[parents[i]];
+		assert(parents[i] == -1U || parents[i] < i);
+		slot_of[handle_of[i]] = i;
+	}
+
+	//slots are now sorted by depth, so levels are contiguous:
+	level_starts.clear();
+	for (uint32_t i = 0; i < size(); ++i) {
+		if (i == 0 || depth[order[i]] != depth[order[i-1]]) level_starts.emplace_back(i);
+	}
+	level_starts.emplace_back(size());
+}
+
+void TransformStore::update() {
+	update_range(0, size());
+}
+
+void TransformStore::update_parallel() {
+	if (size() == 0) return;
+	if (level_starts.empty()) sort();
+
+	if (!pool || pool_threads != threads) {
+		pool.reset(new WorkerPool(threads));
+		pool_threads = threads;
+	}
+
+	//narrow levels are gathered into one serial run (they are contiguous, and in order):
+	uint32_t serial_begin = 0;
+	for (uint32_t l = 0; l + 1 < level_starts.size(); ++l) {
+		uint32_t begin = level_starts[l];
+		uint32_t end = level_starts[l+1];
+		if (pool->size() <= 1 || end - begin < parallel_level_size) continue;
+
+		update_range(serial_begin, begin);
+		serial_begin = end;
+
+		//split level across the pool's threads:
+		pool->parallel_for(end - begin, 1, [this,begin](uint32_t b, uint32_t e) {
+			update_range(begin + b, begin + e);
+		});
+	}
+	update_range(serial_begin, size());
+}
+
+void TransformStore::update_range(uint32_t begin, uint32_t end) {
+	for (uint32_t i = begin; i < end; ++i) {
+		//same matrices as Scene::Transform::make_local_to_parent / make_parent_to_local:
+		glm::mat3 r = glm::mat3_cast(rotations[i]);
+		glm::vec3 const &s = scales[i];
+		glm::mat4x3 local_to_parent = glm::mat4x3(r[0] * s.x, r[1] * s.y, r[2] * s.z, positions[i]);
+
+		glm::vec3 inv_scale;
+		inv_scale.x = (s.x == 0.0f ? 0.0f : 1.0f / s.x);
+		inv_scale.y = (s.y == 0.0f ? 0.0f : 1.0f / s.y);
+		inv_scale.z = (s.z == 0.0f ? 0.0f : 1.0f / s.z);
+		glm::mat3 inv = glm::mat3(
+			glm::vec3(inv_scale.x, 0.0f, 0.0f),
+			glm::vec3(0.0f, inv_scale.y, 0.0f),
+			glm::vec3(0.0f, 0.0f, inv_scale.z)
+		) * glm::mat3_cast(glm::inverse(rotations[i]));
+		glm::mat4x3 parent_to_local = glm::mat4x3(inv[0], inv[1], inv[2], -(inv * positions[i]));
+
+		uint32_t p = parents[i];
+		if (p == -1U) {
+			local_to_worlds[i] = local_to_parent;
+			world_to_locals[i] = parent_to_local;
+		} else {
+			//(parent was already updated this pass)
+			local_to_worlds[i] = compose(local_to_worlds[p], local_to_parent);
+			world_to_locals[i] = compose(parent_to_local, world_to_locals[p]);
+		}
+	}
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+/*
+ * A TransformStore keeps a transform hierarchy in contiguous arrays
+ *  ("structure of arrays": one array each of positions, rotations, scales,
+ *  parents, and world matrices) instead of one heap node per transform,
+ *  as Scene::transforms does.
+ *
+ * Transforms are kept in topological order (every parent before its
+ *  children), so update() computes every world matrix in one linear pass,
+ *  reading each parent's matrix from earlier in the same array.
+ *
+ * For very large hierarchies, update_parallel() sorts transforms by depth
+ *  and splits each wide enough depth level across a WorkerPool (every
+ *  transform in a level only reads matrices from the level above).
+ *  Runs of narrow levels -- e.g., long chains -- are done on the calling
+ *  thread, since waking threads for a handful of transforms costs more
+ *  than it saves.
+ *
+ * Transforms are moved within the arrays to keep that order (on remove()
+ *  and on some set_parent() calls), so they are addressed by Handles, which
+ *  stay valid until the transform is removed.
+ *
+ * This is a separate storage mode: a Scene's transforms can be copied in
+ *  with add_scene(), after which the store can be updated without touching
+ *  the Scene.
+ *
+ */
+
+#include "Scene.hpp"
+#include "WorkerPool.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+//(declared outside TransformStore so it can be a default argument of the store's functions)
+struct TransformHandle {
+	uint32_t index = -1U; //into the store's handle tables
+	uint32_t generation = 0; //(so handles to removed transforms can be told apart from reuses of their index)
+	bool operator==(TransformHandle const &o) const { return index == o.index && generation == o.generation; }
+	bool operator!=(TransformHandle const &o) const { return !(*this == o); }
+};
+
+struct TransformStore {
+	typedef TransformHandle Handle;
+
+	//add a transform (as the last child of 'parent', or as a root if 'parent' is a default Handle):
+	Handle add(Handle parent = Handle(),
+		glm::vec3 const &position = glm::vec3(0.0f),
+		glm::quat const &rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f),
+		glm::vec3 const &scale = glm::vec3(1.0f));
+
+	//add every transform in 'scene' (parents before children, whatever their order in the scene):
+	// returns handles in the same order as scene.transforms
+	std::vector< Handle > add_scene(Scene const &scene);
+
+	//remove a transform (which must not have children -- remove those first):
+	// (O(size()) since later transforms shift down to stay in order)
+	void remove(Handle handle);
+
+	//move a transform (and everything below it) under a new parent (or to the root if 'parent' is a default Handle):
+	// (if the new parent is currently after the transform, the arrays are reordered, which is O(size() log size()))
+	void set_parent(Handle handle, Handle parent);
+
+	bool valid(Handle handle) const;
+	uint32_t size() const { return uint32_t(positions.size()); }
+
+	//local transformation, relative to parent (change freely, then call update()):
+	glm::vec3 &position(Handle handle) { return positions[slot(handle)]; }
+	glm::quat &rotation(Handle handle) { return rotations[slot(handle)]; }
+	glm::vec3 &scale(Handle handle) { return scales[slot(handle)]; }
+	Handle parent(Handle handle) const;
+
+	//world matrices (as of the last update()):
+	glm::mat4x3 const &local_to_world(Handle handle) const { return local_to_worlds[slot(handle)]; }
+	glm::mat4x3 const &world_to_local(Handle handle) const { return world_to_locals[slot(handle)]; }
+
+	//recompute every world matrix (one pass, in order):
+	void update();
+
+	//recompute every world matrix, one depth level at a time, splitting wide levels across threads:
+	// (reorders the arrays by depth if they aren't already)
+	void update_parallel();
+
+	//number of threads update_parallel() uses (0 means one per hardware thread):
+	// (workers are started by the first update_parallel(), and kept until the store is destroyed or this changes)
+	uint32_t threads = 0;
+	//levels with fewer transforms than this are updated on the calling thread:
+	uint32_t parallel_level_size = 4096;
+
+	//-- internals --
+
+	//per-transform data, in topological order ("slots"):
+	std::vector< glm::vec3 > positions;
+	std::vector< glm::quat > rotations;
+	std::vector< glm::vec3 > scales;
+	std::vector< uint32_t > parents; //slot of parent (always less than own slot), or -1U for roots
+	std::vector< glm::mat4x3 > local_to_worlds;
+	std::vector< glm::mat4x3 > world_to_locals;
+	std::vector< uint32_t > handle_of; //slot -> handle index
+
+	//per-handle data:
+	std::vector< uint32_t > slot_of; //handle index -> slot (or -1U if free)
+	std::vector< uint32_t > generations;
+	std::vector< uint32_t > free_handles;
+
+	uint32_t slot(Handle handle) const;
+
+	//reorder slots by depth (which puts parents first, e.g. after a set_parent() that broke the order):
+	void sort();
+
+	//first slot of each depth level (plus size() at the end), if slots are still sorted by depth:
+	// (cleared by anything that might change the order or the levels)
+	std::vector< uint32_t > level_starts;
+
+	//compute world matrices of slots [begin,end) (whose parents must already be done):
+	void update_range(uint32_t begin, uint32_t end);
+
+	std::unique_ptr< WorkerPool > pool;
+	uint32_t pool_threads = 0; //value of 'threads' when 'pool' was made
+};
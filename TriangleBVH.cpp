@@ -0,0 +1,88 @@
+#include "TriangleBVH.hpp"
+
+#include <algorithm>
+
+void TriangleBVH::build(std::vector< glm::vec3 > const &positions, uint32_t start, uint32_t count) {
+	assert(start + count <= positions.size());
+
+	nodes.clear();
+	triangles.clear();
+
+	//gather triangles (and their centroids, which are used to pick splits):
+	std::vector< glm::vec3 > centroids;
+	triangles.reserve(count / 3);
+	centroids.reserve(count / 3);
+	for (uint32_t v = start; v + 2 < start + count; v += 3) {
+		triangles.emplace_back(v);
+		centroids.emplace_back((positions[v+0] + positions[v+1] + positions[v+2]) / 3.0f);
+	}
+	if (triangles.empty()) return;
+
+	//Build top-down, splitting at the median centroid along the widest axis.
+	// (median splits keep the tree balanced, so depth is ~log2(triangles / LeafSize))
+	nodes.reserve(2 * (triangles.size() / LeafSize + 1));
+	nodes.emplace_back();
+
+	struct Task {
+		uint32_t node;
+		uint32_t begin, end; //range in 'triangles'
+	};
+	std::vector< Task > todo;
+	todo.emplace_back(Task{0, 0, uint32_t(triangles.size())});
+
+	//'triangles' and 'centroids' are permuted together via this index:
+	std::vector< uint32_t > order(triangles.size());
+	for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+
+	while (!todo.empty()) {
+		Task task = todo.back();
+		todo.pop_back();
+
+		//compute bounds of triangles and of centroids:
+		glm::vec3 min = glm::vec3( std::numeric_limits< float >::infinity());
+		glm::vec3 max = glm::vec3(-std::numeric_limits< float >::infinity());
+		glm::vec3 c_min = min;
+		glm::vec3 c_max = max;
+		for (uint32_t i = task.begin; i < task.end; ++i) {
+			uint32_t v = triangles[order[i]];
+			min = glm::min(min, glm::min(positions[v+0], glm::min(positions[v+1], positions[v+2])));
+			max = glm::max(max, glm::max(positions[v+0], glm::max(positions[v+1], positions[v+2])));
+			c_min = glm::min(c_min, centroids[order[i]]);
+			c_max = glm::max(c_max, centroids[order[i]]);
+		}
+		nodes[task.node].min = min;
+		nodes[task.node].max = max;
+
+		if (task.end - task.begin <= LeafSize) {
+			nodes[task.node].first = task.begin;
+			nodes[task.node].count = task.end - task.begin;
+			continue;
+		}
+
+		glm::vec3 extent = c_max - c_min;
+		int axis = 0;
+		if (extent.y > extent[axis]) axis = 1;
+		if (extent.z > extent[axis]) axis = 2;
+
+		uint32_t mid = (task.begin + task.end) / 2;
+		std::nth_element(order.begin() + task.begin, order.begin() + mid, order.begin() + task.end,
+			[&centroids,axis](uint32_t a, uint32_t b) {
+				return centroids[a][axis] < centroids[b][axis];
+			});
+
+		uint32_t first = uint32_t(nodes.size());
+		nodes.emplace_back();
+		nodes.emplace_back();
+		nodes[task.node].first = first;
+		nodes[task.node].count = 0;
+
+		todo.emplace_back(Task{first + 0, task.begin, mid});
+		todo.emplace_back(Task{first + 1, mid, task.end});
+	}
+
+	//store triangles in leaf order:
+	std::vector< uint32_t > sorted;
+	sorted.reserve(order.size());
+	for (uint32_t i : order) sorted.emplace_back(triangles[i]);
+	triangles = std::move(sorted);
+}
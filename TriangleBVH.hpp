@@ -0,0 +1,158 @@
+#pragma once
+
+/*
+ * A TriangleBVH is a bounding volume hierarchy over a range of triangles
+ *  stored as consecutive vertex triples (e.g., MeshData::positions).
+ *
+ * It is built once (e.g., when a MeshData is loaded) and can then be
+ *  queried with an axis-aligned box to find the triangles that might
+ *  overlap it, or with a line segment to find the triangles it might
+ *  pass through, which is useful for collision detection.
+ *
+ */
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+struct TriangleBVH {
+	//build over the 'count' vertices starting at 'start' in 'positions':
+	// (count should be a multiple of three; any leftover vertices are ignored)
+	void build(std::vector< glm::vec3 > const &positions, uint32_t start, uint32_t count);
+
+	//call 'fn(uint32_t first_vertex)' for every triangle in a leaf whose bounding box overlaps [min,max]:
+	// (so 'fn' may see some triangles that don't actually overlap the box)
+	template< typename F >
+	void for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const;
+
+	//call 'fn(uint32_t first_vertex)' for every triangle in a leaf whose bounding box is crossed by the
+	//  segment from + s * (to - from), for s in [0, *limit]:
+	// 'fn' returns false to stop early and may lower *limit (e.g., to the closest hit so far) to skip farther nodes.
+	// (nodes are visited near-to-far, so a first-hit search usually stops lowering *limit quickly)
+	template< typename F >
+	void for_each_along_segment(glm::vec3 const &from, glm::vec3 const &to, float *limit, F const &fn) const;
+
+	struct Node {
+		glm::vec3 min = glm::vec3( std::numeric_limits< float >::infinity());
+		uint32_t first = 0; //index of first child (interior nodes) or of first entry in 'triangles' (leaves)
+		glm::vec3 max = glm::vec3(-std::numeric_limits< float >::infinity());
+		uint32_t count = 0; //number of triangles in leaf; 0 for interior nodes (whose children are first and first+1)
+	};
+	static_assert(sizeof(Node) == 32, "Node is packed.");
+
+	//nodes[0] is the root (if there are any triangles at all):
+	std::vector< Node > nodes;
+
+	//index of first vertex of each triangle, in leaf order:
+	std::vector< uint32_t > triangles;
+
+	//leaves hold at most this many triangles:
+	enum : uint32_t { LeafSize = 4 };
+};
+
+//---------------------------
+
+template< typename F >
+void TriangleBVH::for_each_overlapping(glm::vec3 const &min, glm::vec3 const &max, F const &fn) const {
+	if (nodes.empty()) return;
+
+	//tree depth is bounded by the number of splits, which is small in practice:
+	uint32_t stack[64];
+	uint32_t stack_size = 0;
+	stack[stack_size++] = 0;
+
+	while (stack_size) {
+		Node const &node = nodes[stack[--stack_size]];
+		if (node.min.x > max.x || min.x > node.max.x
+		 || node.min.y > max.y || min.y > node.max.y
+		 || node.min.z > max.z || min.z > node.max.z) continue;
+
+		if (node.count) {
+			for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+				fn(triangles[i]);
+			}
+		} else {
+			assert(stack_size + 2 <= 64 && "BVH deeper than traversal stack.");
+			stack[stack_size++] = node.first + 1;
+			stack[stack_size++] = node.first;
+		}
+	}
+}
+
+template< typename F >
+void TriangleBVH::for_each_along_segment(glm::vec3 const &from, glm::vec3 const &to, float *limit, F const &fn) const {
+	assert(limit);
+	if (nodes.empty()) return;
+
+	glm::vec3 dir = to - from;
+	glm::vec3 inv_dir;
+	for (uint32_t i = 0; i < 3; ++i) {
+		inv_dir[i] = (dir[i] == 0.0f ? 0.0f : 1.0f / dir[i]);
+	}
+
+	//segment parameter at which segment enters node's box (or false if it misses):
+	auto enter = [&](Node const &node, float *t_enter) -> bool {
+		float t0 = 0.0f;
+		float t1 = *limit;
+		for (uint32_t i = 0; i < 3; ++i) {
+			if (dir[i] == 0.0f) {
+				if (from[i] < node.min[i] || from[i] > node.max[i]) return false;
+				continue;
+			}
+			float ta = (node.min[i] - from[i]) * inv_dir[i];
+			float tb = (node.max[i] - from[i]) * inv_dir[i];
+			if (ta > tb) std::swap(ta, tb);
+			t0 = std::max(t0, ta);
+			t1 = std::min(t1, tb);
+			if (t0 > t1) return false;
+		}
+		*t_enter = t0;
+		return true;
+	};
+
+	struct Entry {
+		uint32_t node;
+		float t_enter;
+	};
+	Entry stack[64];
+	uint32_t stack_size = 0;
+
+	float root_t;
+	if (!enter(nodes[0], &root_t)) return;
+	stack[stack_size++] = Entry{0, root_t};
+
+	while (stack_size) {
+		Entry entry = stack[--stack_size];
+		if (entry.t_enter > *limit) continue; //a closer hit was found since node was pushed
+		Node const &node = nodes[entry.node];
+
+		if (node.count) {
+			for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+				if (!fn(triangles[i])) return;
+			}
+		} else {
+			float t_a, t_b;
+			bool hit_a = enter(nodes[node.first], &t_a);
+			bool hit_b = enter(nodes[node.first + 1], &t_b);
+			assert(stack_size + 2 <= 64 && "BVH deeper than traversal stack.");
+			//push farther child first so nearer child is visited first:
+			if (hit_a && hit_b) {
+				if (t_a <= t_b) {
+					stack[stack_size++] = Entry{node.first + 1, t_b};
+					stack[stack_size++] = Entry{node.first, t_a};
+				} else {
+					stack[stack_size++] = Entry{node.first, t_a};
+					stack[stack_size++] = Entry{node.first + 1, t_b};
+				}
+			} else if (hit_a) {
+				stack[stack_size++] = Entry{node.first, t_a};
+			} else if (hit_b) {
+				stack[stack_size++] = Entry{node.first + 1, t_b};
+			}
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#include "Triggers.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+uint32_t Triggers::add(Volume const &volume, glm::vec3 const &min, glm::vec3 const &max) {
+	uint32_t id = uint32_t(volumes.size());
+	volumes.emplace_back(volume);
+	grid.update(id, min, max);
+	return id;
+}
+
+uint32_t Triggers::add_sphere(glm::vec3 const &center, float radius, uint32_t user) {
+	Volume volume;
+	volume.shape = Sphere;
+	volume.user = user;
+	volume.center = center;
+	volume.half_size = glm::vec3(radius);
+	return add(volume, center - glm::vec3(radius), center + glm::vec3(radius));
+}
+
+uint32_t Triggers::add_box(glm::vec3 const &min, glm::vec3 const &max, uint32_t user) {
+	Volume volume;
+	volume.shape = Box;
+	volume.user = user;
+	volume.center = 0.5f * (max + min);
+	volume.half_size = 0.5f * (max - min);
+	return add(volume, min, max);
+}
+
+uint32_t Triggers::add_oriented_box(glm::mat4x3 const &to_world, glm::vec3 const &local_min, glm::vec3 const &local_max, uint32_t user) {
+	Volume volume;
+	volume.shape = OrientedBox;
+	volume.user = user;
+
+	glm::vec3 local_center = 0.5f * (local_max + local_min);
+	glm::vec3 local_half = 0.5f * (local_max - local_min);
+	volume.center = to_world * glm::vec4(local_center, 1.0f);
+
+	//split transform's columns into unit axes and (world-space) half sizes:
+	for (uint32_t i = 0; i < 3; ++i) {
+		float len = glm::length(to_world[i]);
+		volume.axes[i] = (len > 0.0f ? to_world[i] / len : glm::vec3(0.0f));
+		volume.half_size[i] = local_half[i] * len;
+	}
+
+	glm::vec3 world_half =
+		  glm::abs(volume.half_size.x * volume.axes[0])
+		+ glm::abs(volume.half_size.y * volume.axes[1])
+		+ glm::abs(volume.half_size.z * volume.axes[2]);
+	return add(volume, volume.center - world_half, volume.center + world_half);
+}
+
+//does segment from + s * (to - from), s in [0,1], pass through box [-half,half]?
+static bool segment_vs_box(glm::vec3 const &from, glm::vec3 const &to, glm::vec3 const &half) {
+	glm::vec3 dir = to - from;
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+	for (uint32_t i = 0; i < 3; ++i) {
+		if (dir[i] == 0.0f) {
+			if (from[i] < -half[i] || from[i] > half[i]) return false;
+			continue;
+		}
+		float ta = (-half[i] - from[i]) / dir[i];
+		float tb = ( half[i] - from[i]) / dir[i];
+		if (ta > tb) std::swap(ta, tb);
+		t0 = std::max(t0, ta);
+		t1 = std::min(t1, tb);
+		if (t0 > t1) return false;
+	}
+	return true;
+}
+
+bool Triggers::touches(Volume const &volume, glm::vec3 const &from, glm::vec3 const &to, float radius) {
+	if (volume.shape == Sphere) {
+		//distance from center to closest point on segment:
+		glm::vec3 dir = to - from;
+		float len2 = glm::dot(dir, dir);
+		float s = (len2 > 0.0f ? glm::clamp(glm::dot(volume.center - from, dir) / len2, 0.0f, 1.0f) : 0.0f);
+		glm::vec3 close = from + s * dir - volume.center;
+		float r = volume.half_size.x + radius;
+		return glm::dot(close, close) <= r * r;
+	} else if (volume.shape == Box) {
+		//(box grown by radius on all sides -- slightly generous near edges and corners)
+		return segment_vs_box(from - volume.center, to - volume.center, volume.half_size + glm::vec3(radius));
+	} else if (volume.shape == OrientedBox) {
+		//same, but in box's frame:
+		glm::mat3 to_box = glm::transpose(volume.axes);
+		return segment_vs_box(to_box * (from - volume.center), to_box * (to - volume.center), volume.half_size + glm::vec3(radius));
+	} else {
+		assert(0 && "unknown trigger shape");
+		return false;
+	}
+}
+
+void Triggers::update(glm::vec3 const &from, glm::vec3 const &to, float radius, std::vector< Event > *events) {
+	assert(events);
+	++stamp;
+
+	//volumes touched this time:
+	glm::vec3 min = glm::min(from, to) - glm::vec3(radius);
+	glm::vec3 max = glm::max(from, to) + glm::vec3(radius);
+	std::vector< uint32_t > touched;
+	grid.for_each_overlapping(min, max, [&](uint32_t id) {
+		Volume &volume = volumes[id];
+		if (!touches(volume, from, to, radius)) return;
+		volume.touched_stamp = stamp;
+		touched.emplace_back(id);
+		if (!volume.inside) {
+			volume.inside = true;
+			events->emplace_back(Event{id, volume.user, true});
+		}
+	});
+
+	//volumes that were inside last time but weren't touched this time:
+	for (uint32_t id : inside) {
+		Volume &volume = volumes[id];
+		if (volume.touched_stamp == stamp) continue;
+		volume.inside = false;
+		events->emplace_back(Event{id, volume.user, false});
+	}
+
+	inside = std::move(touched);
+}
+
+void Triggers::reset() {
+	for (uint32_t id : inside) {
+		volumes[id].inside = false;
+	}
+	inside.clear();
+}
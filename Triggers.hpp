@@ -0,0 +1,74 @@
+#pragma once
+
+/*
+ * Triggers is a set of trigger volumes (spheres, axis-aligned boxes, and
+ *  oriented boxes) that report when something enters or leaves them.
+ *
+ * Volumes are stored in a ColliderGrid, so checking a moving sphere only
+ *  looks at the volumes near its path -- a level can have hundreds of them.
+ *
+ * Call update() once per frame with the path the (player) sphere took:
+ *  a volume is "inside" for a frame if the swept sphere touches it at any point.
+ *
+ */
+
+#include "ColliderGrid.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+
+struct Triggers {
+	//Add volumes; each returns an id (index into 'volumes'):
+	// 'user' is stored with the volume and reported in events (e.g., the index of a goal).
+	uint32_t add_sphere(glm::vec3 const &center, float radius, uint32_t user = 0);
+	uint32_t add_box(glm::vec3 const &min, glm::vec3 const &max, uint32_t user = 0);
+	//box [local_min,local_max] in a space given by 'to_world' (rotation/translation/scale, but no shear):
+	uint32_t add_oriented_box(glm::mat4x3 const &to_world, glm::vec3 const &local_min, glm::vec3 const &local_max, uint32_t user = 0);
+
+	struct Event {
+		uint32_t id; //volume that was entered or left
+		uint32_t user; //volume's 'user' value
+		bool enter; //true if entered, false if left
+	};
+
+	//Check sphere moving from 'from' to 'to' against all volumes:
+	// appends an event to 'events' for each volume whose inside-ness changed since the last update().
+	void update(glm::vec3 const &from, glm::vec3 const &to, float radius, std::vector< Event > *events);
+
+	//Forget inside-ness of all volumes (no events are reported):
+	void reset();
+
+	//-- internals --
+
+	enum Shape : uint8_t {
+		Sphere,
+		Box,
+		OrientedBox,
+	};
+
+	struct Volume {
+		Shape shape = Sphere;
+		bool inside = false; //touched in the last update()
+		uint32_t touched_stamp = 0; //value of 'stamp' at last update() that touched volume
+		uint32_t user = 0;
+		glm::vec3 center = glm::vec3(0.0f);
+		glm::vec3 half_size = glm::vec3(0.0f); //sphere: radius in .x; boxes: half of each side
+		glm::mat3 axes = glm::mat3(1.0f); //oriented box: unit box axes (as columns)
+	};
+	std::vector< Volume > volumes;
+
+	//ids of volumes with inside == true:
+	std::vector< uint32_t > inside;
+
+	//incremented every update():
+	uint32_t stamp = 0;
+
+	ColliderGrid grid;
+
+	uint32_t add(Volume const &volume, glm::vec3 const &min, glm::vec3 const &max);
+
+	//does sphere swept from 'from' to 'to' touch volume?
+	static bool touches(Volume const &volume, glm::vec3 const &from, glm::vec3 const &to, float radius);
+};
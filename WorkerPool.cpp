@@ -0,0 +1,73 @@
+#include "WorkerPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+WorkerPool::WorkerPool(uint32_t threads) {
+	if (threads == 0) threads = std::max(1U, std::thread::hardware_concurrency());
+	workers.reserve(threads - 1);
+	for (uint32_t w = 1; w < threads; ++w) {
+		workers.emplace_back(&WorkerPool::worker_main, this, w);
+	}
+}
+
+WorkerPool::~WorkerPool() {
+	{
+		std::lock_guard< std::mutex > lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+	for (auto &t : workers) {
+		t.join();
+	}
+}
+
+void WorkerPool::parallel_for(uint32_t count, uint32_t min_range, std::function< void(uint32_t, uint32_t) > const &fn) {
+	uint32_t ranges = std::min(size(), count / std::max(1U, min_range));
+
+	if (ranges <= 1) {
+		fn(0, count);
+		return;
+	}
+
+	{ //hand the job to the workers:
+		std::lock_guard< std::mutex > lock(mutex);
+		assert(!job && "parallel_for is not reentrant");
+		job = &fn;
+		job_count = count;
+		job_ranges = ranges;
+		remaining = ranges - 1;
+		generation += 1;
+	}
+	wake.notify_all();
+
+	fn(0, uint32_t(uint64_t(count) / ranges));
+
+	{ //wait for the workers to finish their ranges:
+		std::unique_lock< std::mutex > lock(mutex);
+		done.wait(lock, [this](){ return remaining == 0; });
+		job = nullptr;
+	}
+}
+
+void WorkerPool::worker_main(uint32_t range) {
+	uint64_t seen = 0;
+	std::unique_lock< std::mutex > lock(mutex);
+	while (true) {
+		wake.wait(lock, [&](){ return quit || generation != seen; });
+		if (quit) return;
+		seen = generation;
+		//(jobs split into fewer ranges leave some workers idle)
+		if (range >= job_ranges) continue;
+
+		std::function< void(uint32_t, uint32_t) > const &fn = *job;
+		uint32_t begin = uint32_t(uint64_t(job_count) * range / job_ranges);
+		uint32_t end = uint32_t(uint64_t(job_count) * (range + 1) / job_ranges);
+		lock.unlock();
+		fn(begin, end);
+		lock.lock();
+
+		remaining -= 1;
+		if (remaining == 0) done.notify_one();
+	}
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * A WorkerPool keeps a set of worker threads waiting, so work can be split
+ *  across threads every frame without starting (and joining) new threads
+ *  each time.
+ *
+ * Workers are started when the pool is made, sleep on a condition variable
+ *  between jobs, and are stopped and joined when the pool is destroyed.
+ *
+ */
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+struct WorkerPool {
+	//run jobs on 'threads' threads, counting the calling thread (0 means one per hardware thread):
+	WorkerPool(uint32_t threads = 0);
+	~WorkerPool();
+	WorkerPool(WorkerPool const &) = delete;
+	WorkerPool &operator=(WorkerPool const &) = delete;
+
+	//number of threads jobs are split across (the workers, plus the calling thread):
+	uint32_t size() const { return uint32_t(workers.size()) + 1; }
+
+	//call fn(begin, end) for equal ranges that together cover [0,count), each on its own thread:
+	// - ranges are at least 'min_range' long (so small jobs don't wake threads for a few items),
+	// - the calling thread does the first range itself, then waits for the rest,
+	// - only one thread at a time may call parallel_for on a pool.
+	void parallel_for(uint32_t count, uint32_t min_range, std::function< void(uint32_t, uint32_t) > const &fn);
+
+	//-- internals --
+
+	std::vector< std::thread > workers;
+
+	//current job (guarded by 'mutex'):
+	std::mutex mutex;
+	std::condition_variable wake; //workers wait on this for a new job (or 'quit')
+	std::condition_variable done; //parallel_for waits on this for 'remaining' to reach zero
+	std::function< void(uint32_t, uint32_t) > const *job = nullptr;
+	uint32_t job_count = 0; //items in the job
+	uint32_t job_ranges = 0; //ranges the job is split into (range 0 is the caller's; each worker has its own range number from 1 up)
+	uint32_t remaining = 0; //worker ranges not yet finished
+	uint64_t generation = 0; //incremented for each job (so workers can tell a new job from one they've done)
+	bool quit = false;
+
+	void worker_main(uint32_t range);
+};
@@ -3,6 +3,18 @@
 #include <initializer_list>
 #include <algorithm>
 #include <iostream>
+#include <cmath>
+
+//SIMD instruction sets used by collide_swept_sphere_vs_triangles (if available):
+// (define COLLIDE_NO_SIMD to build with only the scalar code)
+#if defined(COLLIDE_NO_SIMD)
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define COLLIDE_USE_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLLIDE_USE_SSE
+#endif
 
 
 //Check if two AABBs overlap:
@@ -114,12 +126,16 @@ bool collide_ray_vs_cylinder(glm::vec3 ray_start, glm::vec3 ray_direction,
 	glm::vec3 projected_pt = cylinder_a+glm::dot(ray_start-cylinder_a, along)/glm::dot(along, along)*along;
 	glm::vec3 projected_dir = glm::dot(ray_direction, along)/glm::dot(along, along)*along;
 
+	//(the sub-ray starts at time t0; it only needs to reach as far as the earliest hit found so far)
+	if(collision_t) t1 = std::min(t1, *collision_t);
 	float t = t1-t0;
+	if(t <= 0.0f) return false;
 	if(collide_ray_vs_sphere(
 				ray_start-projected_pt+t0*(ray_direction-projected_dir), 
 				 ray_direction-projected_dir, glm::vec3(0.0f), radius,
 			       	&t, nullptr, nullptr)){
-		
+		t += t0; //(back to a time along the whole ray)
+
 		if(collision_t) *collision_t = t;
 		if(collision_out) *collision_out = careful_normalize(ray_start-projected_pt+t*(ray_direction-projected_dir));
 		if(collision_at) *collision_at = ray_start+t*ray_direction-radius*(*collision_out);
@@ -218,3 +234,755 @@ bool collide_swept_sphere_vs_triangle(
 
 	//-----------------------------
 }
+
+//-----------------------------
+
+CollisionTriangle::CollisionTriangle(glm::vec3 const &a_, glm::vec3 const &b_, glm::vec3 const &c_, uint8_t features_)
+	: a(a_), b(b_), c(c_), features(features_) {
+
+	glm::vec3 perp = glm::cross(b-a, c-a);
+	float len2 = glm::dot(perp, perp);
+	if (!(len2 > 0.0f)) {
+		features |= Degenerate;
+		return;
+	}
+	normal = perp * (1.0f / std::sqrt(len2));
+	offset = glm::dot(normal, a);
+
+	ab = b - a;
+	bc = c - b;
+	ca = a - c;
+	auto inv = [](float x) { return (x > 0.0f ? 1.0f / x : 0.0f); };
+	inv_ab2 = inv(glm::dot(ab, ab));
+	inv_bc2 = inv(glm::dot(bc, bc));
+	inv_ca2 = inv(glm::dot(ca, ca));
+
+	ab_in = glm::cross(normal, ab);
+	bc_in = glm::cross(normal, bc);
+	ca_in = glm::cross(normal, ca);
+}
+
+//helper: ray vs cylinder around edge from 'edge_start' along 'along' (with precomputed 1/|along|^2):
+static bool collide_ray_vs_edge(glm::vec3 const &ray_start, glm::vec3 const &ray_direction,
+		glm::vec3 const &edge_start, glm::vec3 const &along, float inv_along2, float radius,
+		float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out)
+{
+	if (inv_along2 == 0.0f) return false; //zero-length edge (covered by vertex tests)
+
+	//same as collide_ray_vs_cylinder, but working in units of the edge's length:
+	float t0 = 0.0f;
+	float t1 = 1.0f;
+
+	float dot_from = glm::dot(ray_start-edge_start, along) * inv_along2;
+	float dot_dir = glm::dot(ray_direction, along) * inv_along2;
+	float dot_to = dot_from + dot_dir;
+
+	if (dot_from < 0.0f) {
+		if (dot_to <= dot_from) return false;
+		t0 = (0.0f - dot_from) / (dot_to - dot_from);
+	}
+	if (dot_from > 1.0f) {
+		if (dot_to >= dot_from) return false;
+		t0 = (1.0f - dot_from) / (dot_to - dot_from);
+	}
+	if (dot_to < 0.0f) {
+		if (dot_from <= dot_to) return false;
+		t1 = (0.0f - dot_from) / (dot_to - dot_from);
+	}
+	if (dot_to > 1.0f) {
+		if (dot_from >= dot_to) return false;
+		t1 = (1.0f - dot_from) / (dot_to - dot_from);
+	}
+
+	glm::vec3 projected_pt = edge_start + dot_from * along;
+	glm::vec3 projected_dir = dot_dir * along;
+
+	//(the sub-ray starts at time t0; it only needs to reach as far as the earliest hit found so far)
+	if (collision_t) t1 = std::min(t1, *collision_t);
+	float t = t1-t0;
+	if (t <= 0.0f) return false;
+	if (collide_ray_vs_sphere(
+			ray_start-projected_pt+t0*(ray_direction-projected_dir),
+			ray_direction-projected_dir, glm::vec3(0.0f), radius,
+			&t, nullptr, nullptr)) {
+		t += t0; //(back to a time along the whole ray)
+		glm::vec3 out = careful_normalize(ray_start-projected_pt+t*(ray_direction-projected_dir));
+		if (collision_t) *collision_t = t;
+		if (collision_out) *collision_out = out;
+		if (collision_at) *collision_at = ray_start+t*ray_direction-radius*out;
+		return true;
+	}
+
+	return false;
+}
+
+bool collide_swept_sphere_vs_triangle(
+	glm::vec3 const &sphere_from, glm::vec3 const &sphere_to, float sphere_radius,
+	CollisionTriangle const &tri,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out
+) {
+	if (tri.features & CollisionTriangle::Degenerate) return false;
+
+	float t = 2.0f;
+	if (collision_t) {
+		t = std::min(t, *collision_t);
+		if (t <= 0.0f) return false;
+	}
+
+	//plane crossing interval (as in the plain version, but with precomputed plane):
+	float dot_from = glm::dot(tri.normal, sphere_from) - tri.offset;
+	float dot_to = glm::dot(tri.normal, sphere_to) - tri.offset;
+
+	float t0 = 1.0f;
+	float t1 = -1.0f;
+	if (dot_from > 0.0f && dot_to < dot_from) {
+		t0 = (sphere_radius - dot_from) / (dot_to - dot_from);
+		t1 = (-sphere_radius - dot_from) / (dot_to - dot_from);
+	} else if (dot_from < 0.0f && dot_to > dot_from) {
+		t0 = (-sphere_radius - dot_from) / (dot_to - dot_from);
+		t1 = (sphere_radius - dot_from) / (dot_to - dot_from);
+	}
+
+	if (t1 < 0.0f || t0 > t) return false;
+
+	float at_t = glm::max(0.0f, t0);
+	glm::vec3 at = glm::mix(sphere_from, sphere_to, at_t);
+
+	glm::vec3 triangle_pt = at - (glm::dot(tri.normal, at) - tri.offset) * tri.normal;
+
+	//inside test using precomputed edge normals:
+	float in_ab = glm::dot(triangle_pt - tri.a, tri.ab_in);
+	float in_bc = glm::dot(triangle_pt - tri.b, tri.bc_in);
+	float in_ca = glm::dot(triangle_pt - tri.c, tri.ca_in);
+	if ((in_ab >= 0.0f && in_bc >= 0.0f && in_ca >= 0.0f)
+	 || (in_ab <= 0.0f && in_bc <= 0.0f && in_ca <= 0.0f)) {
+		if (collision_t) *collision_t = at_t;
+		if (collision_at) *collision_at = triangle_pt;
+		if (collision_out) *collision_out = careful_normalize(at - triangle_pt);
+		return true;
+	}
+
+	glm::vec3 sweep = sphere_to - sphere_from;
+	bool collided = false;
+
+	//vertices:
+	auto vertex = [&](uint8_t flag, glm::vec3 const &pt) {
+		if (!(tri.features & flag)) return;
+		if (collide_ray_vs_sphere(sphere_from, sweep, pt, sphere_radius, collision_t, nullptr, collision_out)) {
+			collided = true;
+			if (collision_at) *collision_at = pt;
+		}
+	};
+	vertex(CollisionTriangle::VertexA, tri.a);
+	vertex(CollisionTriangle::VertexB, tri.b);
+	vertex(CollisionTriangle::VertexC, tri.c);
+
+	//edges:
+	auto edge = [&](uint8_t flag, glm::vec3 const &start, glm::vec3 const &along, float inv_along2) {
+		if (!(tri.features & flag)) return;
+		if (collide_ray_vs_edge(sphere_from, sweep, start, along, inv_along2, sphere_radius, collision_t, collision_at, collision_out)) {
+			collided = true;
+		}
+	};
+	edge(CollisionTriangle::EdgeAB, tri.a, tri.ab, tri.inv_ab2);
+	edge(CollisionTriangle::EdgeBC, tri.b, tri.bc, tri.inv_bc2);
+	edge(CollisionTriangle::EdgeCA, tri.c, tri.ca, tri.inv_ca2);
+
+	return collided;
+}
+
+//-----------------------------
+
+void TriangleBlock::set(uint32_t lane, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+	assert(lane < Width);
+	ax[lane] = a.x; ay[lane] = a.y; az[lane] = a.z;
+	bx[lane] = b.x; by[lane] = b.y; bz[lane] = b.z;
+	cx[lane] = c.x; cy[lane] = c.y; cz[lane] = c.z;
+}
+
+//Which lanes of a TriangleBlock might the swept sphere touch?
+//  This mirrors the first step of collide_swept_sphere_vs_triangle: a triangle can only be hit if the sphere
+//  center comes within radius of the triangle's plane at some time in [0,t]. The limit is padded slightly so
+//  that rounding differences never reject a triangle that the exact test would accept.
+//  (degenerate triangles produce NaN distances, which fail both comparisons -- the exact test rejects them too)
+
+//(the scalar version is always compiled, so collide_swept_sphere_vs_triangles_scalar can check the others against it)
+static uint32_t candidate_lanes_scalar(glm::vec3 const &from, glm::vec3 const &to, float radius, float t,
+	TriangleBlock const &block, uint32_t lane_begin, uint32_t lane_end) {
+	uint32_t mask = 0;
+	for (uint32_t lane = lane_begin; lane < lane_end; ++lane) {
+		glm::vec3 a = block.a(lane);
+		glm::vec3 perp = glm::cross(block.b(lane)-a, block.c(lane)-a);
+		glm::vec3 norm = perp * (1.0f / std::sqrt(glm::dot(perp, perp)));
+		float d_from = glm::dot(norm, from - a);
+		float d_to = glm::dot(norm, to - a);
+		float d_end = d_from + t * (d_to - d_from);
+		float limit = radius + 1e-4f * (radius + std::abs(d_from) + std::abs(d_to));
+		if (d_from * d_end <= 0.0f || std::min(std::abs(d_from), std::abs(d_end)) <= limit) {
+			mask |= (1U << lane);
+		}
+	}
+	return mask;
+}
+
+#if defined(COLLIDE_USE_AVX)
+static uint32_t candidate_lanes_avx(glm::vec3 const &from, glm::vec3 const &to, float radius, float t,
+	TriangleBlock const &block) {
+	static_assert(TriangleBlock::Width == 8, "AVX path handles exactly eight lanes.");
+
+	__m256 ax = _mm256_load_ps(block.ax), ay = _mm256_load_ps(block.ay), az = _mm256_load_ps(block.az);
+	__m256 e1x = _mm256_sub_ps(_mm256_load_ps(block.bx), ax);
+	__m256 e1y = _mm256_sub_ps(_mm256_load_ps(block.by), ay);
+	__m256 e1z = _mm256_sub_ps(_mm256_load_ps(block.bz), az);
+	__m256 e2x = _mm256_sub_ps(_mm256_load_ps(block.cx), ax);
+	__m256 e2y = _mm256_sub_ps(_mm256_load_ps(block.cy), ay);
+	__m256 e2z = _mm256_sub_ps(_mm256_load_ps(block.cz), az);
+
+	//perp = cross(e1, e2), norm = perp / |perp|:
+	__m256 px = _mm256_sub_ps(_mm256_mul_ps(e1y, e2z), _mm256_mul_ps(e1z, e2y));
+	__m256 py = _mm256_sub_ps(_mm256_mul_ps(e1z, e2x), _mm256_mul_ps(e1x, e2z));
+	__m256 pz = _mm256_sub_ps(_mm256_mul_ps(e1x, e2y), _mm256_mul_ps(e1y, e2x));
+	__m256 len2 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, px), _mm256_mul_ps(py, py)), _mm256_mul_ps(pz, pz));
+	__m256 inv = _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(len2));
+	__m256 nx = _mm256_mul_ps(px, inv), ny = _mm256_mul_ps(py, inv), nz = _mm256_mul_ps(pz, inv);
+
+	//signed distances of sweep endpoints from plane:
+	__m256 d_from = _mm256_add_ps(_mm256_add_ps(
+		_mm256_mul_ps(nx, _mm256_sub_ps(_mm256_set1_ps(from.x), ax)),
+		_mm256_mul_ps(ny, _mm256_sub_ps(_mm256_set1_ps(from.y), ay))),
+		_mm256_mul_ps(nz, _mm256_sub_ps(_mm256_set1_ps(from.z), az)));
+	__m256 d_to = _mm256_add_ps(_mm256_add_ps(
+		_mm256_mul_ps(nx, _mm256_sub_ps(_mm256_set1_ps(to.x), ax)),
+		_mm256_mul_ps(ny, _mm256_sub_ps(_mm256_set1_ps(to.y), ay))),
+		_mm256_mul_ps(nz, _mm256_sub_ps(_mm256_set1_ps(to.z), az)));
+	__m256 d_end = _mm256_add_ps(d_from, _mm256_mul_ps(_mm256_set1_ps(t), _mm256_sub_ps(d_to, d_from)));
+
+	__m256 sign = _mm256_set1_ps(-0.0f);
+	__m256 abs_from = _mm256_andnot_ps(sign, d_from);
+	__m256 abs_to = _mm256_andnot_ps(sign, d_to);
+	__m256 abs_end = _mm256_andnot_ps(sign, d_end);
+	__m256 r = _mm256_set1_ps(radius);
+	__m256 limit = _mm256_add_ps(r, _mm256_mul_ps(_mm256_set1_ps(1e-4f), _mm256_add_ps(r, _mm256_add_ps(abs_from, abs_to))));
+
+	__m256 crosses = _mm256_cmp_ps(_mm256_mul_ps(d_from, d_end), _mm256_setzero_ps(), _CMP_LE_OQ);
+	__m256 near = _mm256_cmp_ps(_mm256_min_ps(abs_from, abs_end), limit, _CMP_LE_OQ);
+	return uint32_t(_mm256_movemask_ps(_mm256_or_ps(crosses, near)));
+}
+#endif
+
+#if defined(COLLIDE_USE_SSE)
+static uint32_t candidate_lanes_sse(glm::vec3 const &from, glm::vec3 const &to, float radius, float t,
+	TriangleBlock const &block, uint32_t lane_begin) {
+	assert(lane_begin % 4 == 0 && lane_begin + 4 <= TriangleBlock::Width);
+
+	__m128 ax = _mm_load_ps(block.ax + lane_begin), ay = _mm_load_ps(block.ay + lane_begin), az = _mm_load_ps(block.az + lane_begin);
+	__m128 e1x = _mm_sub_ps(_mm_load_ps(block.bx + lane_begin), ax);
+	__m128 e1y = _mm_sub_ps(_mm_load_ps(block.by + lane_begin), ay);
+	__m128 e1z = _mm_sub_ps(_mm_load_ps(block.bz + lane_begin), az);
+	__m128 e2x = _mm_sub_ps(_mm_load_ps(block.cx + lane_begin), ax);
+	__m128 e2y = _mm_sub_ps(_mm_load_ps(block.cy + lane_begin), ay);
+	__m128 e2z = _mm_sub_ps(_mm_load_ps(block.cz + lane_begin), az);
+
+	//perp = cross(e1, e2), norm = perp / |perp|:
+	__m128 px = _mm_sub_ps(_mm_mul_ps(e1y, e2z), _mm_mul_ps(e1z, e2y));
+	__m128 py = _mm_sub_ps(_mm_mul_ps(e1z, e2x), _mm_mul_ps(e1x, e2z));
+	__m128 pz = _mm_sub_ps(_mm_mul_ps(e1x, e2y), _mm_mul_ps(e1y, e2x));
+	__m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(px, px), _mm_mul_ps(py, py)), _mm_mul_ps(pz, pz));
+	__m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(len2));
+	__m128 nx = _mm_mul_ps(px, inv), ny = _mm_mul_ps(py, inv), nz = _mm_mul_ps(pz, inv);
+
+	//signed distances of sweep endpoints from plane:
+	__m128 d_from = _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(nx, _mm_sub_ps(_mm_set1_ps(from.x), ax)),
+		_mm_mul_ps(ny, _mm_sub_ps(_mm_set1_ps(from.y), ay))),
+		_mm_mul_ps(nz, _mm_sub_ps(_mm_set1_ps(from.z), az)));
+	__m128 d_to = _mm_add_ps(_mm_add_ps(
+		_mm_mul_ps(nx, _mm_sub_ps(_mm_set1_ps(to.x), ax)),
+		_mm_mul_ps(ny, _mm_sub_ps(_mm_set1_ps(to.y), ay))),
+		_mm_mul_ps(nz, _mm_sub_ps(_mm_set1_ps(to.z), az)));
+	__m128 d_end = _mm_add_ps(d_from, _mm_mul_ps(_mm_set1_ps(t), _mm_sub_ps(d_to, d_from)));
+
+	__m128 sign = _mm_set1_ps(-0.0f);
+	__m128 abs_from = _mm_andnot_ps(sign, d_from);
+	__m128 abs_to = _mm_andnot_ps(sign, d_to);
+	__m128 abs_end = _mm_andnot_ps(sign, d_end);
+	__m128 r = _mm_set1_ps(radius);
+	__m128 limit = _mm_add_ps(r, _mm_mul_ps(_mm_set1_ps(1e-4f), _mm_add_ps(r, _mm_add_ps(abs_from, abs_to))));
+
+	__m128 crosses = _mm_cmple_ps(_mm_mul_ps(d_from, d_end), _mm_setzero_ps());
+	__m128 near = _mm_cmple_ps(_mm_min_ps(abs_from, abs_end), limit);
+	return uint32_t(_mm_movemask_ps(_mm_or_ps(crosses, near))) << lane_begin;
+}
+#endif
+
+//Same time limit as collide_swept_sphere_vs_triangle (or 0.0f if nothing can be hit):
+static float block_time_limit(TriangleBlock const &block, float const *collision_t) {
+	assert(block.count <= TriangleBlock::Width);
+	if (block.count == 0) return 0.0f;
+	float t = 2.0f;
+	if (collision_t) t = std::min(t, *collision_t);
+	return std::max(t, 0.0f);
+}
+
+//Run the exact test on the lanes in 'mask', in order:
+// (the last lane to report a hit is the earliest hit, as with repeated calls to the single-triangle test)
+static uint32_t collide_lanes(uint32_t mask,
+	glm::vec3 const &sphere_from, glm::vec3 const &sphere_to, float sphere_radius,
+	TriangleBlock const &block,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out
+) {
+	mask &= (1U << block.count) - 1U; //ignore unused lanes
+	uint32_t hit = -1U;
+	for (uint32_t lane = 0; mask; ++lane, mask >>= 1) {
+		if (!(mask & 1U)) continue;
+		if (collide_swept_sphere_vs_triangle(sphere_from, sphere_to, sphere_radius,
+			block.a(lane), block.b(lane), block.c(lane),
+			collision_t, collision_at, collision_out)) {
+			hit = lane;
+		}
+	}
+	return hit;
+}
+
+uint32_t collide_swept_sphere_vs_triangles(
+	glm::vec3 const &sphere_from, glm::vec3 const &sphere_to, float sphere_radius,
+	TriangleBlock const &block,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out
+) {
+	float t = block_time_limit(block, collision_t);
+	if (t <= 0.0f) return -1U;
+
+	//(1) find lanes that might be hit, several at once:
+	uint32_t mask;
+	#if defined(COLLIDE_USE_AVX)
+	mask = candidate_lanes_avx(sphere_from, sphere_to, sphere_radius, t, block);
+	#elif defined(COLLIDE_USE_SSE)
+	mask = candidate_lanes_sse(sphere_from, sphere_to, sphere_radius, t, block, 0);
+	if (block.count > 4) mask |= candidate_lanes_sse(sphere_from, sphere_to, sphere_radius, t, block, 4);
+	#else
+	mask = candidate_lanes_scalar(sphere_from, sphere_to, sphere_radius, t, block, 0, block.count);
+	#endif
+
+	//(2) run exact test on remaining lanes:
+	return collide_lanes(mask, sphere_from, sphere_to, sphere_radius, block, collision_t, collision_at, collision_out);
+}
+
+uint32_t collide_swept_sphere_vs_triangles_scalar(
+	glm::vec3 const &sphere_from, glm::vec3 const &sphere_to, float sphere_radius,
+	TriangleBlock const &block,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out
+) {
+	float t = block_time_limit(block, collision_t);
+	if (t <= 0.0f) return -1U;
+
+	uint32_t mask = candidate_lanes_scalar(sphere_from, sphere_to, sphere_radius, t, block, 0, block.count);
+	return collide_lanes(mask, sphere_from, sphere_to, sphere_radius, block, collision_t, collision_at, collision_out);
+}
+
+char const *collide_swept_sphere_vs_triangles_simd() {
+	#if defined(COLLIDE_USE_AVX)
+	return "AVX";
+	#elif defined(COLLIDE_USE_SSE)
+	return "SSE";
+	#else
+	return "none";
+	#endif
+}
+
+glm::vec3 closest_point_on_triangle(
+	glm::vec3 const &pt,
+	glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) {
+
+	//check which (vertex, edge, or face) region pt projects into:
+	glm::vec3 ab = b - a;
+	glm::vec3 ac = c - a;
+	glm::vec3 ap = pt - a;
+	float d1 = glm::dot(ab, ap);
+	float d2 = glm::dot(ac, ap);
+	glm::vec3 bp = pt - b;
+	float d3 = glm::dot(ab, bp);
+	float d4 = glm::dot(ac, bp);
+	glm::vec3 cp = pt - c;
+	float d5 = glm::dot(ab, cp);
+	float d6 = glm::dot(ac, cp);
+
+	float vc = d1 * d4 - d3 * d2;
+	float vb = d5 * d2 - d1 * d6;
+	float va = d3 * d6 - d5 * d4;
+
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		return a; //vertex a
+	} else if (d3 >= 0.0f && d4 <= d3) {
+		return b; //vertex b
+	} else if (d6 >= 0.0f && d5 <= d6) {
+		return c; //vertex c
+	} else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		return a + (d1 / (d1 - d3)) * ab; //edge ab
+	} else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		return a + (d2 / (d2 - d6)) * ac; //edge ac
+	} else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b); //edge bc
+	} else {
+		float denom = va + vb + vc;
+		if (denom == 0.0f) return a; //degenerate triangle
+		return a + (vb / denom) * ab + (vc / denom) * ac; //face
+	}
+}
+
+bool collide_sphere_vs_triangle(
+	glm::vec3 const &sphere_center, float sphere_radius,
+	glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c,
+	glm::vec3 *closest_) {
+
+	glm::vec3 closest = closest_point_on_triangle(sphere_center, a, b, c);
+
+	glm::vec3 to_center = sphere_center - closest;
+	if (glm::dot(to_center, to_center) > sphere_radius * sphere_radius) return false;
+
+	if (closest_) *closest_ = closest;
+	return true;
+}
+
+bool collide_ray_vs_triangle(
+	glm::vec3 const &ray_start, glm::vec3 const &ray_direction,
+	glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c,
+	float *collision_t, glm::vec3 *collision_out) {
+
+	float t = 1.0f;
+	if (collision_t) {
+		t = std::min(t, *collision_t);
+		if (t <= 0.0f) return false;
+	}
+
+	//Moller-Trumbore: solve ray_start + s * ray_direction == a + u * (b-a) + v * (c-a):
+	glm::vec3 ab = b - a;
+	glm::vec3 ac = c - a;
+	glm::vec3 p = glm::cross(ray_direction, ac);
+	float det = glm::dot(ab, p);
+	if (det == 0.0f) return false; //ray parallel to triangle (or triangle degenerate)
+	float inv_det = 1.0f / det;
+
+	glm::vec3 from_a = ray_start - a;
+	float u = glm::dot(from_a, p) * inv_det;
+	if (u < 0.0f || u > 1.0f) return false;
+
+	glm::vec3 q = glm::cross(from_a, ab);
+	float v = glm::dot(ray_direction, q) * inv_det;
+	if (v < 0.0f || u + v > 1.0f) return false;
+
+	float s = glm::dot(ac, q) * inv_det;
+	if (s < 0.0f || s >= t) return false;
+
+	if (collision_t) *collision_t = s;
+	if (collision_out) {
+		//normal on the side of the triangle the ray came from:
+		glm::vec3 n = careful_normalize(glm::cross(ab, ac));
+		*collision_out = (glm::dot(n, ray_direction) > 0.0f ? -n : n);
+	}
+	return true;
+}
+
+bool collide_ray_vs_triangle(
+	glm::vec3 const &ray_start, glm::vec3 const &ray_direction,
+	CollisionTriangle const &tri,
+	float *collision_t, glm::vec3 *collision_out) {
+	if (tri.features & CollisionTriangle::Degenerate) return false;
+
+	float t = 1.0f;
+	if (collision_t) {
+		t = std::min(t, *collision_t);
+		if (t <= 0.0f) return false;
+	}
+
+	//where does ray cross triangle's plane?
+	float along = glm::dot(tri.normal, ray_direction);
+	if (along == 0.0f) return false; //ray parallel to plane
+	float s = (tri.offset - glm::dot(tri.normal, ray_start)) / along;
+	if (s < 0.0f || s >= t) return false;
+
+	//is crossing point inside triangle?
+	glm::vec3 pt = ray_start + s * ray_direction;
+	if (glm::dot(pt - tri.a, tri.ab_in) < 0.0f) return false;
+	if (glm::dot(pt - tri.b, tri.bc_in) < 0.0f) return false;
+	if (glm::dot(pt - tri.c, tri.ca_in) < 0.0f) return false;
+
+	if (collision_t) *collision_t = s;
+	if (collision_out) *collision_out = (along > 0.0f ? -tri.normal : tri.normal);
+	return true;
+}
+
+//---------------------------
+//analytic primitives:
+
+CollisionPrimitive CollisionPrimitive::sphere(glm::vec3 const &center, float radius) {
+	CollisionPrimitive ret;
+	ret.type = Sphere;
+	ret.a = ret.b = center;
+	ret.radius = radius;
+	return ret;
+}
+
+CollisionPrimitive CollisionPrimitive::capsule(glm::vec3 const &a, glm::vec3 const &b, float radius) {
+	CollisionPrimitive ret;
+	ret.type = Capsule;
+	ret.a = a;
+	ret.b = b;
+	ret.radius = radius;
+	return ret;
+}
+
+CollisionPrimitive CollisionPrimitive::box(glm::vec3 const &min, glm::vec3 const &max) {
+	CollisionPrimitive ret;
+	ret.type = Box;
+	ret.a = ret.b = 0.5f * (min + max);
+	ret.half_size = 0.5f * (max - min);
+	return ret;
+}
+
+CollisionPrimitive CollisionPrimitive::transformed(glm::mat4x3 const &xf) const {
+	CollisionPrimitive ret = *this;
+	ret.a = xf * glm::vec4(a, 1.0f);
+	ret.b = xf * glm::vec4(b, 1.0f);
+	glm::vec3 scale = glm::vec3(glm::length(xf[0]), glm::length(xf[1]), glm::length(xf[2]));
+	if (type == Box) {
+		//box axes are carried along by the transform (assumed to have no shear):
+		glm::mat3 along = glm::mat3(xf) * axes;
+		for (uint32_t i = 0; i < 3; ++i) {
+			float len = glm::length(along[i]);
+			ret.axes[i] = (len > 0.0f ? along[i] / len : axes[i]);
+			ret.half_size[i] = half_size[i] * len;
+		}
+	} else {
+		ret.radius = radius * std::max(scale.x, std::max(scale.y, scale.z));
+	}
+	return ret;
+}
+
+void CollisionPrimitive::bounds(glm::vec3 *min, glm::vec3 *max) const {
+	assert(min && max);
+	if (type == Box) {
+		glm::vec3 reach = glm::abs(half_size.x * axes[0]) + glm::abs(half_size.y * axes[1]) + glm::abs(half_size.z * axes[2]);
+		*min = a - reach;
+		*max = a + reach;
+	} else {
+		*min = glm::min(a, b) - glm::vec3(radius);
+		*max = glm::max(a, b) + glm::vec3(radius);
+	}
+}
+
+//helper: point on segment a-b closest to pt:
+static glm::vec3 closest_point_on_segment(glm::vec3 const &pt, glm::vec3 const &a, glm::vec3 const &b) {
+	glm::vec3 ab = b - a;
+	float len2 = glm::dot(ab, ab);
+	if (len2 == 0.0f) return a;
+	float s = glm::clamp(glm::dot(pt - a, ab) / len2, 0.0f, 1.0f);
+	return a + s * ab;
+}
+
+glm::vec3 CollisionPrimitive::closest_point(glm::vec3 const &pt) const {
+	if (type == Box) {
+		glm::vec3 local = glm::transpose(axes) * (pt - a);
+		return a + axes * glm::clamp(local, -half_size, half_size);
+	} else {
+		glm::vec3 core = closest_point_on_segment(pt, a, b);
+		glm::vec3 to_pt = pt - core;
+		float len2 = glm::dot(to_pt, to_pt);
+		if (len2 <= radius * radius) return pt;
+		return core + (radius / std::sqrt(len2)) * to_pt;
+	}
+}
+
+//helper: first time in [0, *t) that a ray starting outside a capsule enters it:
+// (a sphere is a capsule with a == b)
+static bool ray_enters_capsule(glm::vec3 const &start, glm::vec3 const &dir,
+	glm::vec3 const &a, glm::vec3 const &b, float radius, float *t) {
+	float dd = glm::dot(dir, dir);
+	if (!(dd > 0.0f)) return false;
+
+	bool found = false;
+	auto consider = [&](float s) {
+		if (s >= 0.0f && s < *t) {
+			*t = s;
+			found = true;
+		}
+	};
+
+	//end spheres:
+	for (glm::vec3 const &end : {a, b}) {
+		glm::vec3 from_end = start - end;
+		float half_b = glm::dot(dir, from_end);
+		float d = half_b * half_b - dd * (glm::dot(from_end, from_end) - radius * radius);
+		if (d >= 0.0f) consider((-half_b - std::sqrt(d)) / dd);
+	}
+
+	//side of cylinder between them: (entering through the flat ends means entering an end sphere first)
+	glm::vec3 ab = b - a;
+	float ab2 = glm::dot(ab, ab);
+	if (ab2 > 0.0f) {
+		glm::vec3 from_a = start - a;
+		float ab_dir = glm::dot(ab, dir);
+		float ab_from = glm::dot(ab, from_a);
+		float qa = ab2 * dd - ab_dir * ab_dir;
+		float qb = ab2 * glm::dot(dir, from_a) - ab_from * ab_dir;
+		float qc = ab2 * glm::dot(from_a, from_a) - ab_from * ab_from - radius * radius * ab2;
+		float d = qb * qb - qa * qc;
+		if (qa > 0.0f && d >= 0.0f) {
+			float s = (-qb - std::sqrt(d)) / qa;
+			float along = ab_from + s * ab_dir;
+			if (along >= 0.0f && along <= ab2) consider(s);
+		}
+	}
+
+	return found;
+}
+
+//helper: swept sphere vs oriented box, as a ray vs the box grown by the sphere's radius:
+// (follows "Intersecting Moving Sphere Against AABB" from Ericson's Real-Time Collision Detection)
+static bool collide_swept_sphere_vs_box(glm::vec3 const &from, glm::vec3 const &to, float radius,
+	CollisionPrimitive const &box, float t, float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out) {
+
+	//work in box space:
+	glm::mat3 to_box = glm::transpose(box.axes);
+	glm::vec3 const &half = box.half_size;
+	glm::vec3 p = to_box * (from - box.a);
+	glm::vec3 d = to_box * (to - from);
+
+	glm::vec3 hit_local; //point on box
+	glm::vec3 out_local;
+	float hit_t;
+
+	glm::vec3 on_box = glm::clamp(p, -half, half);
+	glm::vec3 gap = p - on_box;
+	if (glm::dot(gap, gap) <= radius * radius) {
+		//already touching; collide now unless moving away:
+		if (gap == glm::vec3(0.0f)) {
+			//center is inside the box; push out through the nearest face:
+			glm::vec3 depth = half - glm::abs(p);
+			uint32_t i = (depth.x <= depth.y && depth.x <= depth.z ? 0 : (depth.y <= depth.z ? 1 : 2));
+			out_local = glm::vec3(0.0f);
+			out_local[i] = (p[i] < 0.0f ? -1.0f : 1.0f);
+			on_box[i] = out_local[i] * half[i];
+		} else {
+			out_local = glm::normalize(gap);
+		}
+		if (glm::dot(d, out_local) >= 0.0f) return false;
+		hit_t = 0.0f;
+		hit_local = on_box;
+	} else {
+		//slab test vs box grown by radius:
+		glm::vec3 grown = half + glm::vec3(radius);
+		float t0 = 0.0f;
+		float t1 = t;
+		int32_t enter_axis = -1;
+		for (int32_t i = 0; i < 3; ++i) {
+			if (d[i] == 0.0f) {
+				if (p[i] < -grown[i] || p[i] > grown[i]) return false;
+				continue;
+			}
+			float s0 = (-grown[i] - p[i]) / d[i];
+			float s1 = ( grown[i] - p[i]) / d[i];
+			if (s0 > s1) std::swap(s0, s1);
+			if (s0 > t0) {
+				t0 = s0;
+				enter_axis = i;
+			}
+			t1 = std::min(t1, s1);
+			if (t0 > t1) return false;
+		}
+		if (t0 >= t) return false;
+
+		//if the grown box is entered beyond two or three of the (un-grown) box's faces, the rounded
+		// edge or corner is what would be hit, so test the capsules around the edges there:
+		glm::vec3 enter = p + t0 * d;
+		float const slop = 1e-5f * (1.0f + std::max(half.x, std::max(half.y, half.z)));
+		bool beyond[3];
+		uint32_t count = 0;
+		for (uint32_t i = 0; i < 3; ++i) {
+			beyond[i] = (std::abs(enter[i]) > half[i] + slop);
+			if (beyond[i]) count += 1;
+		}
+		if (count >= 2 || enter_axis == -1) {
+			glm::vec3 corner = glm::vec3(enter.x < 0.0f ? -half.x : half.x, enter.y < 0.0f ? -half.y : half.y, enter.z < 0.0f ? -half.z : half.z);
+			hit_t = t;
+			bool found = false;
+			for (uint32_t k = 0; k < 3; ++k) {
+				if (!beyond[(k + 1) % 3] || !beyond[(k + 2) % 3]) continue;
+				glm::vec3 edge_a = corner;
+				glm::vec3 edge_b = corner;
+				edge_a[k] = -half[k];
+				edge_b[k] = half[k];
+				if (ray_enters_capsule(p, d, edge_a, edge_b, radius, &hit_t)) found = true;
+			}
+			if (!found) return false;
+			glm::vec3 at = p + hit_t * d;
+			hit_local = glm::clamp(at, -half, half);
+			out_local = careful_normalize(at - hit_local);
+		} else {
+			//face hit:
+			hit_t = t0;
+			hit_local = glm::clamp(enter, -half, half);
+			out_local = glm::vec3(0.0f);
+			out_local[enter_axis] = (d[enter_axis] < 0.0f ? 1.0f : -1.0f);
+		}
+	}
+
+	if (collision_t) *collision_t = hit_t;
+	if (collision_at) *collision_at = box.a + box.axes * hit_local;
+	if (collision_out) *collision_out = box.axes * out_local;
+	return true;
+}
+
+bool collide_swept_sphere_vs_primitive(
+	glm::vec3 const &sphere_from, glm::vec3 const &sphere_to, float sphere_radius,
+	CollisionPrimitive const &primitive,
+	float *collision_t, glm::vec3 *collision_at, glm::vec3 *collision_out) {
+
+	float t = 1.0f;
+	if (collision_t) {
+		t = std::min(t, *collision_t);
+		if (t <= 0.0f) return false;
+	}
+
+	if (primitive.type == CollisionPrimitive::Box) {
+		return collide_swept_sphere_vs_box(sphere_from, sphere_to, sphere_radius, primitive, t, collision_t, collision_at, collision_out);
+	}
+
+	//sphere or capsule; as a ray vs the capsule grown by the sphere's radius:
+	glm::vec3 dir = sphere_to - sphere_from;
+	float reach = primitive.radius + sphere_radius;
+	float hit_t;
+	glm::vec3 center;
+
+	glm::vec3 core = closest_point_on_segment(sphere_from, primitive.a, primitive.b);
+	if (glm::dot(sphere_from - core, sphere_from - core) <= reach * reach) {
+		//already touching; collide now unless moving away:
+		if (glm::dot(dir, sphere_from - core) >= 0.0f) return false;
+		hit_t = 0.0f;
+		center = sphere_from;
+	} else {
+		hit_t = t;
+		if (!ray_enters_capsule(sphere_from, dir, primitive.a, primitive.b, reach, &hit_t)) return false;
+		center = sphere_from + hit_t * dir;
+		core = closest_point_on_segment(center, primitive.a, primitive.b);
+	}
+
+	glm::vec3 out = careful_normalize(center - core);
+	if (collision_t) *collision_t = hit_t;
+	if (collision_at) *collision_at = core + primitive.radius * out;
+	if (collision_out) *collision_out = out;
+	return true;
+}
+
+bool collide_sphere_vs_primitive(
+	glm::vec3 const &sphere_center, float sphere_radius,
+	CollisionPrimitive const &primitive,
+	glm::vec3 *closest_) {
+
+	glm::vec3 closest = primitive.closest_point(sphere_center);
+
+	glm::vec3 to_center = sphere_center - closest;
+	if (glm::dot(to_center, to_center) > sphere_radius * sphere_radius) return false;
+
+	if (closest_) *closest_ = closest;
+	return true;
+}
@@ -2,6 +2,8 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
+
 //Collision functions:
 
 //Check if two Axis-Aligned Bounding Boxes overlap:
@@ -27,3 +29,213 @@ bool collide_swept_sphere_vs_triangle(
 	glm::vec3 *collision_at = nullptr, //[optional,out] point where sphere touches triangle
 	glm::vec3 *collision_out = nullptr //[optional,out] direction to move sphere to get away from triangle as quickly as possible (basically, the outward normal)
 );
+
+//Triangle with precomputed data for the swept sphere test:
+struct CollisionTriangle {
+	CollisionTriangle() = default;
+	//compute plane, edges, etc. from corners:
+	CollisionTriangle(glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c, uint8_t features = AllFeatures);
+
+	//corners:
+	glm::vec3 a = glm::vec3(0.0f), b = glm::vec3(0.0f), c = glm::vec3(0.0f);
+
+	//plane: dot(normal, x) == offset for x in the plane:
+	glm::vec3 normal = glm::vec3(0.0f);
+	float offset = 0.0f;
+
+	//edge vectors and their inverse squared lengths (0 for zero-length edges):
+	glm::vec3 ab = glm::vec3(0.0f), bc = glm::vec3(0.0f), ca = glm::vec3(0.0f); //b-a, c-b, a-c
+	float inv_ab2 = 0.0f, inv_bc2 = 0.0f, inv_ca2 = 0.0f;
+
+	//in-plane edge normals -- cross(normal, edge) -- used to check if a point is inside the triangle:
+	glm::vec3 ab_in = glm::vec3(0.0f), bc_in = glm::vec3(0.0f), ca_in = glm::vec3(0.0f);
+
+	//which vertex and edge features this triangle should test:
+	// (triangles in a mesh share vertices and edges; testing each shared feature once is enough)
+	enum : uint8_t {
+		VertexA = 0x01, VertexB = 0x02, VertexC = 0x04,
+		EdgeAB = 0x08, EdgeBC = 0x10, EdgeCA = 0x20,
+		AllFeatures = 0x3f,
+		Degenerate = 0x80, //zero-area triangle (never collides)
+	};
+	uint8_t features = AllFeatures;
+};
+
+//Check a swept sphere vs a precomputed triangle:
+// same results as the plain version above, except that features (vertices and edges) missing from
+// triangle.features are skipped. (so a hit on a shared feature may be reported by a neighboring triangle)
+bool collide_swept_sphere_vs_triangle(
+	//swept sphere:
+	glm::vec3 const &sphere_from,
+	glm::vec3 const &sphere_to,
+	float sphere_radius,
+	//triangle:
+	CollisionTriangle const &triangle,
+	//output:
+	float *collision_t = nullptr, //[optional,in+out] first time where sphere touches triangle
+	glm::vec3 *collision_at = nullptr, //[optional,out] point where sphere touches triangle
+	glm::vec3 *collision_out = nullptr //[optional,out] direction to move sphere to get away from triangle as quickly as possible
+);
+
+//Triangles stored in structure-of-arrays form, for batched tests:
+struct TriangleBlock {
+	enum : uint32_t { Width = 8 };
+
+	//vertex coordinates, one lane per triangle:
+	alignas(32) float ax[Width], ay[Width], az[Width];
+	alignas(32) float bx[Width], by[Width], bz[Width];
+	alignas(32) float cx[Width], cy[Width], cz[Width];
+
+	uint32_t count = 0; //number of lanes in use (lanes [count,Width) are ignored)
+
+	//store triangle (a,b,c) in lane 'lane':
+	void set(uint32_t lane, glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c);
+	//append triangle (a,b,c) to the block (block must not be full):
+	void push(glm::vec3 const &a, glm::vec3 const &b, glm::vec3 const &c) { set(count++, a, b, c); }
+	//retrieve triangle in lane 'lane':
+	glm::vec3 a(uint32_t lane) const { return glm::vec3(ax[lane], ay[lane], az[lane]); }
+	glm::vec3 b(uint32_t lane) const { return glm::vec3(bx[lane], by[lane], bz[lane]); }
+	glm::vec3 c(uint32_t lane) const { return glm::vec3(cx[lane], cy[lane], cz[lane]); }
+};
+
+//Check a swept sphere vs all the triangles in a block:
+// returns index of the lane whose triangle is hit first, or -1U if none are hit.
+// results (including collision_t/at/out) are the same as calling collide_swept_sphere_vs_triangle
+//  on each triangle in lane order; SSE/AVX (when available) is used to quickly reject lanes that can't be hit.
+uint32_t collide_swept_sphere_vs_triangles(
+	//swept sphere:
+	glm::vec3 const &sphere_from,
+	glm::vec3 const &sphere_to,
+	float sphere_radius,
+	//triangles:
+	TriangleBlock const &block,
+	//output:
+	float *collision_t = nullptr, //[optional,in+out] first time where sphere touches a triangle
+	glm::vec3 *collision_at = nullptr, //[optional,out] point where sphere touches triangle
+	glm::vec3 *collision_out = nullptr //[optional,out] direction to move sphere to get away from triangle as quickly as possible
+);
+
+//The same, rejecting lanes with portable scalar code even when SSE/AVX is available:
+// (results are identical; used to check the SIMD code against it)
+uint32_t collide_swept_sphere_vs_triangles_scalar(
+	glm::vec3 const &sphere_from,
+	glm::vec3 const &sphere_to,
+	float sphere_radius,
+	TriangleBlock const &block,
+	float *collision_t = nullptr,
+	glm::vec3 *collision_at = nullptr,
+	glm::vec3 *collision_out = nullptr
+);
+
+//Which SIMD instruction set collide_swept_sphere_vs_triangles was compiled with ("AVX", "SSE", or "none"):
+// (build with COLLIDE_NO_SIMD defined to force "none")
+char const *collide_swept_sphere_vs_triangles_simd();
+
+//Find the point on a triangle closest to 'pt':
+glm::vec3 closest_point_on_triangle(
+	glm::vec3 const &pt,
+	glm::vec3 const &triangle_a,
+	glm::vec3 const &triangle_b,
+	glm::vec3 const &triangle_c
+);
+
+//Check a (not moving) sphere vs a single triangle:
+// returns 'true' if any part of the triangle is within sphere_radius of sphere_center
+bool collide_sphere_vs_triangle(
+	//sphere:
+	glm::vec3 const &sphere_center,
+	float sphere_radius,
+	//triangle:
+	glm::vec3 const &triangle_a,
+	glm::vec3 const &triangle_b,
+	glm::vec3 const &triangle_c,
+	//output:
+	glm::vec3 *closest = nullptr //[optional,out] point on triangle closest to sphere_center
+);
+
+//Check a ray (segment from ray_start to ray_start + ray_direction) vs a single triangle:
+// returns 'true' on collision; triangles are hit from either side
+bool collide_ray_vs_triangle(
+	//ray:
+	glm::vec3 const &ray_start,
+	glm::vec3 const &ray_direction,
+	//triangle:
+	glm::vec3 const &triangle_a,
+	glm::vec3 const &triangle_b,
+	glm::vec3 const &triangle_c,
+	//output:
+	float *collision_t = nullptr, //[optional,in+out] first time (in [0,1]) where ray hits triangle
+	glm::vec3 *collision_out = nullptr //[optional,out] triangle normal on the side the ray came from
+);
+
+//Check a ray vs a precomputed triangle:
+// (same as above, but faster)
+bool collide_ray_vs_triangle(
+	//ray:
+	glm::vec3 const &ray_start,
+	glm::vec3 const &ray_direction,
+	//triangle:
+	CollisionTriangle const &triangle,
+	//output:
+	float *collision_t = nullptr, //[optional,in+out] first time (in [0,1]) where ray hits triangle
+	glm::vec3 *collision_out = nullptr //[optional,out] triangle normal on the side the ray came from
+);
+
+//Analytic (solid) collision shapes:
+// a single closed-form test replaces testing every triangle of a mesh with the same shape.
+struct CollisionPrimitive {
+	enum Type : uint8_t {
+		Sphere, //ball of 'radius' around 'a'
+		Capsule, //points within 'radius' of segment 'a'-'b'
+		Box, //oriented box centered at 'a', extending 'half_size' along each of 'axes' (unit length)
+	} type = Sphere;
+
+	glm::vec3 a = glm::vec3(0.0f);
+	glm::vec3 b = glm::vec3(0.0f);
+	float radius = 0.0f;
+	glm::mat3 axes = glm::mat3(1.0f);
+	glm::vec3 half_size = glm::vec3(0.0f);
+
+	static CollisionPrimitive sphere(glm::vec3 const &center, float radius);
+	static CollisionPrimitive capsule(glm::vec3 const &a, glm::vec3 const &b, float radius);
+	static CollisionPrimitive box(glm::vec3 const &min, glm::vec3 const &max); //(axis-aligned)
+
+	//the same shape after transforming by 'xf':
+	// (non-uniform scale is exact for boxes; spheres and capsules scale their radius by the largest axis scale)
+	CollisionPrimitive transformed(glm::mat4x3 const &xf) const;
+
+	//axis-aligned bounds:
+	void bounds(glm::vec3 *min, glm::vec3 *max) const;
+
+	//point on (or in) the shape closest to 'pt':
+	glm::vec3 closest_point(glm::vec3 const &pt) const;
+};
+
+//Check a swept sphere vs a primitive:
+// same conventions as collide_swept_sphere_vs_triangle; a sphere that starts out touching the
+// primitive collides at t = 0 unless it is moving away from it.
+// (sphere_radius may be zero, which makes this a ray test)
+bool collide_swept_sphere_vs_primitive(
+	//swept sphere:
+	glm::vec3 const &sphere_from,
+	glm::vec3 const &sphere_to,
+	float sphere_radius,
+	//primitive:
+	CollisionPrimitive const &primitive,
+	//output:
+	float *collision_t = nullptr, //[optional,in+out] first time where sphere touches primitive
+	glm::vec3 *collision_at = nullptr, //[optional,out] point where sphere touches primitive
+	glm::vec3 *collision_out = nullptr //[optional,out] direction to move sphere to get away from primitive as quickly as possible
+);
+
+//Check a (not moving) sphere vs a primitive:
+// returns 'true' if any part of the primitive is within sphere_radius of sphere_center
+bool collide_sphere_vs_primitive(
+	//sphere:
+	glm::vec3 const &sphere_center,
+	float sphere_radius,
+	//primitive:
+	CollisionPrimitive const &primitive,
+	//output:
+	glm::vec3 *closest = nullptr //[optional,out] point on primitive closest to sphere_center
+);
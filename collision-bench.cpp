@@ -0,0 +1,434 @@
+#include "BenchLevel.hpp"
+#include "collide.hpp"
+#include "data_path.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/*
+ * collision-bench times the collision code on the game's own levels,
+ *  without opening a window or making a GL context:
+ *  (1) collide_swept_sphere_vs_triangle alone, on random sweeps near random level triangles
+ *      (and collide_swept_sphere_vs_primitive on sweeps near random box colliders);
+ *  (2) the AABB early-out (sweep box vs triangle box) on the same sweeps;
+ *  (2b) collide_swept_sphere_vs_triangles on blocks of nearby level triangles, checked against
+ *      collide_swept_sphere_vs_triangle on each lane, with both the SIMD and the scalar lane rejection;
+ *  (3) CollisionWorld::slide_sphere on many spheres rolling through the level, as in the game's update;
+ *  (4) CollisionWorld::sweep_sphere one sweep at a time vs. sweep_spheres on the same sweeps;
+ *  (5) CollisionWorld::collider_moved on some of the level's colliders, as for moving platforms.
+ * Sweeps are generated from a seed, so runs are comparable.
+ *
+ * usage: ./collision-bench [seed] [tests-per-level]
+ *
+ */
+
+template< typename F >
+static double time_seconds(F const &fn) {
+	auto before = std::chrono::high_resolution_clock::now();
+	fn();
+	auto after = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration< double >(after - before).count();
+}
+
+static std::string percent(uint64_t count, uint64_t total) {
+	std::ostringstream str;
+	str << std::fixed << std::setprecision(1) << (total ? 100.0 * double(count) / double(total) : 0.0) << "%";
+	return str.str();
+}
+
+static std::string rate(uint64_t count, double seconds) {
+	std::ostringstream str;
+	str << std::fixed << std::setprecision(2) << (seconds > 0.0 ? double(count) / seconds * 1e-6 : 0.0) << "M/s";
+	return str.str();
+}
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+	try { //windows doesn't print nice errors for unhandled exceptions, so we need to.
+#endif
+	uint32_t seed = (argc > 1 ? uint32_t(std::stoul(argv[1])) : 1);
+	uint32_t tests = (argc > 2 ? uint32_t(std::stoul(argv[2])) : 1000000);
+	if (argc > 3) {
+		std::cerr << "Usage:\n\t./collision-bench [seed] [tests-per-level]\n";
+		return 1;
+	}
+
+	//load meshes without uploading them (there is no GL context):
+	MeshData roll_meshes(data_path("roll-parts.pnct"));
+	MeshData fly_meshes(data_path("fly-parts.pnct"));
+
+	std::list< BenchLevel > levels;
+	levels.emplace_back("roll-level-1.scene", roll_meshes, false);
+	levels.emplace_back("roll-level-2.scene", roll_meshes, false);
+	levels.emplace_back("roll-level-3.scene", roll_meshes, false);
+	levels.emplace_back("fly-level-1.scene", fly_meshes, true);
+
+	std::cout << "seed " << seed << ", " << tests << " tests per level; triangle blocks use SIMD: "
+		<< collide_swept_sphere_vs_triangles_simd() << "." << std::endl;
+
+	//results are summed into this so the compiler can't skip the work:
+	float checksum = 0.0f;
+	//set if the triangle block kernels ever disagree with the single-triangle test (makes the exit status nonzero):
+	bool block_mismatches = false;
+
+	for (auto &level : levels) {
+		std::mt19937 mt(seed);
+		auto uniform = [&mt](float lo, float hi) {
+			return std::uniform_real_distribution< float >(lo, hi)(mt);
+		};
+		auto direction = [&]() {
+			glm::vec3 dir;
+			do {
+				dir = glm::vec3(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f));
+			} while (glm::dot(dir, dir) > 1.0f || glm::dot(dir, dir) < 1e-4f);
+			return glm::normalize(dir);
+		};
+
+		std::vector< CollisionTriangle > const &triangles = level.collision.static_collision->triangles;
+		std::cout << "Level '" << level.name << "': " << level.collision.colliders.size() << " colliders, "
+			<< triangles.size() << " baked triangles." << std::endl;
+		if (level.collision.colliders.empty()) continue;
+
+		//--- (1) + (2): sweeps starting within a few units of a random triangle ---
+		if (!triangles.empty()) {
+			struct Sweep {
+				glm::vec3 from, to;
+				float radius;
+				uint32_t triangle;
+			};
+			std::vector< Sweep > sweeps;
+			sweeps.reserve(tests);
+			for (uint32_t i = 0; i < tests; ++i) {
+				Sweep sweep;
+				sweep.triangle = std::uniform_int_distribution< uint32_t >(0, uint32_t(triangles.size()) - 1)(mt);
+				CollisionTriangle const &tri = triangles[sweep.triangle];
+				float u = uniform(0.0f, 1.0f), v = uniform(0.0f, 1.0f);
+				if (u + v > 1.0f) { u = 1.0f - u; v = 1.0f - v; }
+				glm::vec3 on = tri.a + u * (tri.b - tri.a) + v * (tri.c - tri.a);
+				sweep.from = on + uniform(0.0f, 3.0f) * direction();
+				sweep.to = sweep.from + uniform(0.0f, 2.0f) * direction();
+				sweep.radius = uniform(0.25f, 1.5f);
+				sweeps.emplace_back(sweep);
+			}
+
+			uint64_t hits = 0;
+			double swept_seconds = time_seconds([&](){
+				for (auto const &sweep : sweeps) {
+					CollisionTriangle const &tri = triangles[sweep.triangle];
+					float t = 1.0f;
+					if (collide_swept_sphere_vs_triangle(sweep.from, sweep.to, sweep.radius, tri.a, tri.b, tri.c, &t)) {
+						++hits;
+						checksum += t;
+					}
+				}
+			});
+			std::cout << std::left << std::setw(34) << "  swept sphere vs triangle:" << tests << " tests in " << swept_seconds << "s ("
+				<< rate(tests, swept_seconds) << "); "
+				<< percent(hits, tests) << " hit, " << percent(tests - hits, tests) << " miss." << std::endl;
+
+			std::vector< glm::vec3 > tri_min, tri_max;
+			tri_min.reserve(triangles.size());
+			tri_max.reserve(triangles.size());
+			for (auto const &tri : triangles) {
+				tri_min.emplace_back(glm::min(glm::min(tri.a, tri.b), tri.c));
+				tri_max.emplace_back(glm::max(glm::max(tri.a, tri.b), tri.c));
+			}
+			uint64_t passed = 0;
+			double aabb_seconds = time_seconds([&](){
+				for (auto const &sweep : sweeps) {
+					glm::vec3 min = glm::min(sweep.from, sweep.to) - glm::vec3(sweep.radius);
+					glm::vec3 max = glm::max(sweep.from, sweep.to) + glm::vec3(sweep.radius);
+					if (collide_AABB_vs_AABB(min, max, tri_min[sweep.triangle], tri_max[sweep.triangle])) {
+						++passed;
+					}
+				}
+			});
+			std::cout << std::setw(34) << "  AABB early-out:" << tests << " tests in " << aabb_seconds << "s ("
+				<< rate(tests, aabb_seconds) << "); "
+				<< percent(passed, tests) << " pass, " << percent(tests - passed, tests) << " rejected"
+				<< " (" << percent(hits, passed) << " of passing sweeps hit)." << std::endl;
+
+			//--- (2b): blocks of (up to eight) consecutive baked triangles -- which are usually neighbors -- ---
+			// with sweeps starting near one of them; the block kernels must agree exactly with the single-triangle test
+			struct BlockSweep {
+				glm::vec3 from, to;
+				float radius;
+				float t; //(starting time limit; sometimes less than 1, as when a closer hit was already found)
+				TriangleBlock block;
+			};
+			uint32_t const block_tests = std::max(1U, tests / TriangleBlock::Width);
+			std::vector< BlockSweep > block_sweeps(block_tests);
+			for (auto &sweep : block_sweeps) {
+				uint32_t count = std::uniform_int_distribution< uint32_t >(1, TriangleBlock::Width)(mt);
+				uint32_t first = std::uniform_int_distribution< uint32_t >(0, uint32_t(triangles.size()) - 1)(mt);
+				for (uint32_t i = 0; i < count; ++i) {
+					CollisionTriangle const &tri = triangles[(first + i) % triangles.size()];
+					sweep.block.push(tri.a, tri.b, tri.c);
+				}
+				uint32_t lane = std::uniform_int_distribution< uint32_t >(0, count - 1)(mt);
+				float u = uniform(0.0f, 1.0f), v = uniform(0.0f, 1.0f);
+				if (u + v > 1.0f) { u = 1.0f - u; v = 1.0f - v; }
+				glm::vec3 a = sweep.block.a(lane);
+				glm::vec3 on = a + u * (sweep.block.b(lane) - a) + v * (sweep.block.c(lane) - a);
+				sweep.from = on + uniform(0.0f, 3.0f) * direction();
+				sweep.to = sweep.from + uniform(0.0f, 2.0f) * direction();
+				sweep.radius = uniform(0.25f, 1.5f);
+				sweep.t = (uniform(0.0f, 1.0f) < 0.25f ? uniform(0.0f, 1.0f) : 1.0f);
+			}
+
+			struct BlockResult {
+				uint32_t lane = -1U;
+				float t = 1.0f;
+				glm::vec3 at = glm::vec3(0.0f);
+				glm::vec3 out = glm::vec3(0.0f);
+			};
+			auto run_blocks = [&](std::vector< BlockResult > *results_, auto const &collide_block) {
+				std::vector< BlockResult > &results = *results_;
+				results.assign(block_sweeps.size(), BlockResult());
+				return time_seconds([&](){
+					for (uint32_t i = 0; i < block_sweeps.size(); ++i) {
+						BlockSweep const &sweep = block_sweeps[i];
+						BlockResult &result = results[i];
+						result.t = sweep.t;
+						result.lane = collide_block(sweep, &result);
+					}
+				});
+			};
+			std::vector< BlockResult > expected, simd, scalar;
+			double lanes_seconds = run_blocks(&expected, [](BlockSweep const &sweep, BlockResult *result) {
+				uint32_t hit = -1U;
+				for (uint32_t lane = 0; lane < sweep.block.count; ++lane) {
+					if (collide_swept_sphere_vs_triangle(sweep.from, sweep.to, sweep.radius,
+						sweep.block.a(lane), sweep.block.b(lane), sweep.block.c(lane),
+						&result->t, &result->at, &result->out)) {
+						hit = lane;
+					}
+				}
+				return hit;
+			});
+			double simd_seconds = run_blocks(&simd, [](BlockSweep const &sweep, BlockResult *result) {
+				return collide_swept_sphere_vs_triangles(sweep.from, sweep.to, sweep.radius, sweep.block,
+					&result->t, &result->at, &result->out);
+			});
+			double scalar_seconds = run_blocks(&scalar, [](BlockSweep const &sweep, BlockResult *result) {
+				return collide_swept_sphere_vs_triangles_scalar(sweep.from, sweep.to, sweep.radius, sweep.block,
+					&result->t, &result->at, &result->out);
+			});
+
+			//results differ if a different lane (or none) was hit, or if the hit was reported differently:
+			auto mismatches = [&](std::vector< BlockResult > const &results, uint64_t *hit_differ, uint64_t *t_differ) {
+				*hit_differ = *t_differ = 0;
+				for (uint32_t i = 0; i < block_tests; ++i) {
+					BlockResult const &want = expected[i];
+					BlockResult const &got = results[i];
+					if (got.lane != want.lane) ++*hit_differ;
+					else if (got.lane != -1U && (got.t != want.t || got.at != want.at || got.out != want.out)) ++*t_differ;
+				}
+			};
+			uint64_t block_hits = 0;
+			for (auto const &result : expected) {
+				if (result.lane != -1U) {
+					++block_hits;
+					checksum += result.t;
+				}
+			}
+			uint64_t simd_hit_differ, simd_t_differ, scalar_hit_differ, scalar_t_differ;
+			mismatches(simd, &simd_hit_differ, &simd_t_differ);
+			mismatches(scalar, &scalar_hit_differ, &scalar_t_differ);
+			if (simd_hit_differ || simd_t_differ || scalar_hit_differ || scalar_t_differ) block_mismatches = true;
+
+			std::cout << std::setw(34) << "  triangle blocks, lane by lane:" << block_tests << " blocks in " << lanes_seconds << "s ("
+				<< rate(block_tests, lanes_seconds) << "); " << percent(block_hits, block_tests) << " hit." << std::endl;
+			std::cout << std::setw(34) << "  triangle blocks, SIMD rejection:" << block_tests << " blocks in " << simd_seconds << "s ("
+				<< rate(block_tests, simd_seconds) << "); " << simd_hit_differ << " hits differ, " << simd_t_differ << " t differ." << std::endl;
+			std::cout << std::setw(34) << "  triangle blocks, scalar rejection:" << block_tests << " blocks in " << scalar_seconds << "s ("
+				<< rate(block_tests, scalar_seconds) << "); " << scalar_hit_differ << " hits differ, " << scalar_t_differ << " t differ." << std::endl;
+		}
+
+		//--- (1b): sweeps starting within a few units of a random point on a random box collider ---
+		std::vector< CollisionPrimitive > boxes;
+		for (auto const &collider : level.collision.colliders) {
+			if (!collider.mesh && collider.world_primitive.type == CollisionPrimitive::Box) boxes.emplace_back(collider.world_primitive);
+		}
+		if (!boxes.empty()) {
+			struct BoxSweep {
+				glm::vec3 from, to;
+				float radius;
+				uint32_t box;
+			};
+			std::vector< BoxSweep > sweeps;
+			sweeps.reserve(tests);
+			for (uint32_t i = 0; i < tests; ++i) {
+				BoxSweep sweep;
+				sweep.box = std::uniform_int_distribution< uint32_t >(0, uint32_t(boxes.size()) - 1)(mt);
+				CollisionPrimitive const &box = boxes[sweep.box];
+				//random point on a random face:
+				glm::vec3 local = glm::vec3(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f));
+				uint32_t face = std::uniform_int_distribution< uint32_t >(0, 5)(mt);
+				local[face / 2] = (face % 2 ? 1.0f : -1.0f);
+				glm::vec3 on = box.a + box.axes * (local * box.half_size);
+				sweep.from = on + uniform(0.0f, 3.0f) * direction();
+				sweep.to = sweep.from + uniform(0.0f, 2.0f) * direction();
+				sweep.radius = uniform(0.25f, 1.5f);
+				sweeps.emplace_back(sweep);
+			}
+
+			uint64_t hits = 0;
+			double swept_seconds = time_seconds([&](){
+				for (auto const &sweep : sweeps) {
+					float t = 1.0f;
+					if (collide_swept_sphere_vs_primitive(sweep.from, sweep.to, sweep.radius, boxes[sweep.box], &t)) {
+						++hits;
+						checksum += t;
+					}
+				}
+			});
+			std::cout << std::left << std::setw(34) << "  swept sphere vs box:" << tests << " tests in " << swept_seconds << "s ("
+				<< rate(tests, swept_seconds) << "); "
+				<< percent(hits, tests) << " hit, " << percent(tests - hits, tests) << " miss." << std::endl;
+		}
+
+		//--- (3): spheres rolling through the level, one slide per sphere per frame ---
+		uint32_t const Spheres = 64;
+		uint32_t const frames = std::max(1U, tests / (Spheres * 16));
+		float const elapsed = 1.0f / 60.0f;
+		float const radius = 1.0f; //player sphere is radius-1
+
+		for (bool use_distance_field : {false, true}) {
+			if (use_distance_field && !level.collision.distance_field()) continue;
+			level.collision.use_distance_field = use_distance_field;
+
+			mt.seed(seed);
+			struct Roller {
+				glm::vec3 position, velocity;
+				CollisionWorld::SlideCache cache;
+			};
+			std::vector< Roller > rollers(Spheres);
+			for (auto &roller : rollers) {
+				//start just above a random collider:
+				CollisionWorld::Collider const &collider = level.collision.colliders[std::uniform_int_distribution< uint32_t >(0, uint32_t(level.collision.colliders.size()) - 1)(mt)];
+				roller.position = 0.5f * (collider.world_min + collider.world_max);
+				roller.position.z = collider.world_max.z + radius + 0.1f;
+				roller.velocity = uniform(0.0f, 50.0f) * direction();
+			}
+
+			//slides that took 1, 2, 3, 4+ sweeps (each hit after the first sweep costs another):
+			uint64_t sweep_counts[4] = {0, 0, 0, 0};
+			uint64_t contacts = 0;
+			double slide_seconds = time_seconds([&](){
+				for (uint32_t frame = 0; frame < frames; ++frame) {
+					for (auto &roller : rollers) {
+						roller.velocity += elapsed * glm::vec3(0.0f, 0.0f, -10.0f);
+						uint64_t iterations_before = roller.cache.iterations;
+						level.collision.slide_sphere(&roller.position, &roller.velocity, radius, elapsed,
+							[&contacts](CollisionWorld::Hit const &hit, glm::vec3 const &, glm::vec3 *velocity) {
+								++contacts;
+								float d = glm::dot(*velocity, hit.out);
+								if (d < 0.0f) *velocity -= (1.1f * d) * hit.out;
+							},
+							CollisionWorld::LayerSolid, nullptr, 10, &roller.cache);
+						uint64_t sweeps = roller.cache.iterations - iterations_before;
+						sweep_counts[std::min< uint64_t >(std::max< uint64_t >(sweeps, 1), 4) - 1] += 1;
+						checksum += roller.position.z;
+					}
+				}
+			});
+			uint64_t slides = uint64_t(frames) * Spheres;
+			std::cout << std::setw(34) << (use_distance_field ? "  slide_sphere (distance field):" : "  slide_sphere:")
+				<< slides << " slides in " << slide_seconds << "s (" << rate(slides, slide_seconds) << "); sweeps per slide "
+				<< "1: " << percent(sweep_counts[0], slides)
+				<< ", 2: " << percent(sweep_counts[1], slides)
+				<< ", 3: " << percent(sweep_counts[2], slides)
+				<< ", 4+: " << percent(sweep_counts[3], slides)
+				<< "; " << double(contacts) / double(slides) << " contacts per slide." << std::endl;
+		}
+
+		//--- (4): many sweeps near random colliders, one at a time and then through sweep_spheres ---
+		{
+			mt.seed(seed);
+			std::vector< CollisionWorld::SphereCast > casts(tests);
+			for (auto &cast : casts) {
+				CollisionWorld::Collider const &collider = level.collision.colliders[std::uniform_int_distribution< uint32_t >(0, uint32_t(level.collision.colliders.size()) - 1)(mt)];
+				glm::vec3 mix = glm::vec3(uniform(0.0f, 1.0f), uniform(0.0f, 1.0f), uniform(0.0f, 1.0f));
+				cast.from = glm::mix(collider.world_min, collider.world_max, mix) + uniform(0.0f, 3.0f) * direction();
+				cast.to = cast.from + uniform(0.0f, 2.0f) * direction();
+				cast.radius = uniform(0.25f, 1.5f);
+			}
+
+			std::vector< CollisionWorld::Hit > single(tests);
+			std::vector< bool > single_collided(tests);
+			double single_seconds = time_seconds([&](){
+				for (uint32_t i = 0; i < tests; ++i) {
+					single_collided[i] = level.collision.sweep_sphere(casts[i].from, casts[i].to, casts[i].radius, &single[i]);
+				}
+			});
+			double batch_seconds = time_seconds([&](){
+				level.collision.sweep_spheres(&casts);
+			});
+
+			uint64_t hits = 0;
+			uint64_t differ = 0;
+			for (uint32_t i = 0; i < tests; ++i) {
+				if (casts[i].collided) {
+					++hits;
+					checksum += casts[i].hit.t;
+				}
+				if (casts[i].collided != single_collided[i] || (casts[i].collided && casts[i].hit.t != single[i].t)) ++differ;
+			}
+			std::cout << std::setw(34) << "  sweep_sphere (one at a time):" << tests << " sweeps in " << single_seconds << "s ("
+				<< rate(tests, single_seconds) << "); " << percent(hits, tests) << " hit." << std::endl;
+			std::cout << std::setw(34) << "  sweep_spheres:" << tests << " sweeps in " << batch_seconds << "s ("
+				<< rate(tests, batch_seconds) << "); " << differ << " results differ." << std::endl;
+		}
+
+		//--- (5): every fourth collider bobbing up and down, like a moving platform ---
+		// (done last, since it un-bakes the colliders it moves)
+		{
+			std::vector< uint32_t > platforms;
+			for (uint32_t id = 0; id < level.collision.colliders.size(); id += 4) {
+				platforms.emplace_back(id);
+			}
+			uint32_t const frames = std::max(1U, tests / 100);
+			double move_seconds = time_seconds([&](){
+				for (uint32_t frame = 0; frame < frames; ++frame) {
+					float dz = 0.05f * std::sin(float(frame) * elapsed);
+					for (uint32_t id : platforms) {
+						level.collision.colliders[id].transform->position.z += dz;
+						level.collision.collider_moved(id);
+					}
+				}
+			});
+			for (uint32_t id : platforms) {
+				checksum += level.collision.colliders[id].world_max.z;
+			}
+			uint64_t moves = uint64_t(frames) * platforms.size();
+			std::cout << std::setw(34) << "  collider_moved:" << moves << " moves in " << move_seconds << "s ("
+				<< rate(moves, move_seconds) << "); " << platforms.size() << " of " << level.collision.colliders.size()
+				<< " colliders moving." << std::endl;
+		}
+	}
+
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+
+	if (block_mismatches) {
+		std::cerr << "Triangle block results differ from collide_swept_sphere_vs_triangle!" << std::endl;
+		return 1;
+	}
+	return 0;
+#ifdef _WIN32
+	} catch (std::exception &e) {
+		std::cerr << "UNHANDLED EXCEPTION:\n" << e.what() << std::endl;
+		return 1;
+	}
+#endif
+}
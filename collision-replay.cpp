@@ -0,0 +1,173 @@
+#include "BenchLevel.hpp"
+#include "CollisionStats.hpp"
+#include "CollisionTrace.hpp"
+#include "data_path.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * collision-replay re-runs a trace of collision queries recorded during play
+ *  (press '5' in FlyMode to start/stop recording to collision-trace.bin)
+ *  against a level loaded without a window or GL context, and reports:
+ *  - time spent per kind of query (best of 'repeats' passes), and
+ *  - how many results differ from those recorded (so a change to the collision
+ *    code can be checked against real play as well as timed on it).
+ * If a .csv file is given, the cost of the first pass is also counted per
+ *  collider (see CollisionStats.hpp) and written there, as one frame.
+ *
+ * usage: ./collision-replay <trace> <level.scene> [repeats] [stats.csv]
+ *
+ */
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+	try { //windows doesn't print nice errors for unhandled exceptions, so we need to.
+#endif
+	if (argc < 3 || argc > 5) {
+		std::cerr << "Usage:\n\t./collision-replay <trace> <level.scene> [repeats] [stats.csv]\n";
+		return 1;
+	}
+	std::string trace_file = argv[1];
+	std::string scene_file = argv[2];
+	uint32_t repeats = (argc > 3 ? std::max(1U, uint32_t(std::stoul(argv[3]))) : 5);
+	std::string stats_file = (argc > 4 ? argv[4] : "");
+
+	CollisionTrace trace;
+	trace.load(trace_file);
+
+	//fly levels use fly-parts, as in FlyLevel.cpp; everything else is a roll level:
+	bool fly = (scene_file.substr(0, 4) == "fly-");
+	MeshData meshes(data_path(fly ? "fly-parts.pnct" : "roll-parts.pnct"));
+	//only build a distance field (which is slow) if queries were recorded using one:
+	bool distance_field = false;
+	for (auto const &record : trace.records) {
+		if (record.kind == CollisionTrace::SweepSphereDistanceField || record.use_distance_field) distance_field = true;
+	}
+	BenchLevel level(scene_file, meshes, fly && distance_field);
+
+	std::cout << "Trace '" << trace_file << "': " << trace.records.size() << " queries." << std::endl;
+	std::cout << "Level '" << level.name << "': " << level.collision.colliders.size() << " colliders, "
+		<< level.collision.static_collision->triangles.size() << " baked triangles." << std::endl;
+	if (trace.header.colliders != level.collision.colliders.size()
+	 || trace.header.baked_triangles != level.collision.static_collision->triangles.size()) {
+		std::cerr << "WARNING: trace was recorded on a level with " << trace.header.colliders << " colliders and "
+			<< trace.header.baked_triangles << " baked triangles; results will likely differ." << std::endl;
+	}
+
+	static char const *kind_names[] = {
+		"sweep_sphere",
+		"sweep_sphere_distance_field",
+		"raycast",
+		"raycast_any",
+		"slide_sphere",
+	};
+	enum : uint32_t { Kinds = 5 };
+
+	struct Stats {
+		uint32_t count = 0;
+		double seconds = 1e30; //(best pass)
+		uint32_t differ = 0; //results where collided / collider differs from the recording
+		float max_t_delta = 0.0f;
+		float max_position_delta = 0.0f; //(slide_sphere only)
+	};
+	Stats stats[Kinds];
+
+	for (auto const &record : trace.records) {
+		if (record.kind >= Kinds) {
+			std::cerr << "Trace has a record of unknown kind " << record.kind << "." << std::endl;
+			return 1;
+		}
+		stats[record.kind].count += 1;
+	}
+
+	CollisionWorld::SlideCache cache;
+	std::unique_ptr< CollisionStats > collider_stats;
+	if (stats_file != "") collider_stats.reset(new CollisionStats(level.collision));
+
+	for (uint32_t pass = 0; pass < repeats; ++pass) {
+		//(counting slows queries down, so only the first pass counts; with more than one pass, it isn't the best)
+		level.collision.stats = (pass == 0 ? collider_stats.get() : nullptr);
+		double seconds[Kinds] = {0.0};
+		for (auto const &record : trace.records) {
+			//replay one query (timed alone, so kinds can be told apart in the mix the game actually made):
+			bool collided = false;
+			CollisionWorld::Hit hit;
+			glm::vec3 position = record.from;
+			glm::vec3 velocity = record.to;
+
+			auto before = std::chrono::high_resolution_clock::now();
+			if (record.kind == CollisionTrace::SweepSphere) {
+				collided = level.collision.sweep_sphere(record.from, record.to, record.radius, &hit, record.layers);
+			} else if (record.kind == CollisionTrace::SweepSphereDistanceField) {
+				collided = level.collision.sweep_sphere_distance_field(record.from, record.to, record.radius, &hit, record.layers);
+			} else if (record.kind == CollisionTrace::Raycast) {
+				collided = level.collision.raycast(record.from, record.to, &hit, record.layers);
+			} else if (record.kind == CollisionTrace::RaycastAny) {
+				collided = level.collision.raycast_any(record.from, record.to, record.layers);
+			} else { assert(record.kind == CollisionTrace::SlideSphere);
+				level.collision.use_distance_field = (record.use_distance_field != 0);
+				collided = true; //(not reported by slide_sphere; compared by end position instead)
+				level.collision.slide_sphere(&position, &velocity, record.radius, record.elapsed, nullptr, record.layers,
+					nullptr, 10, &cache);
+			}
+			auto after = std::chrono::high_resolution_clock::now();
+			seconds[record.kind] += std::chrono::duration< double >(after - before).count();
+
+			if (pass != 0) continue;
+
+			//compare with recorded results on the first pass:
+			Stats &s = stats[record.kind];
+			if (record.kind == CollisionTrace::SlideSphere) {
+				s.max_position_delta = std::max(s.max_position_delta, glm::length(position - record.at));
+			} else if (collided != (record.collided != 0)) {
+				s.differ += 1;
+			} else if (collided && record.kind != CollisionTrace::RaycastAny) {
+				if (hit.collider != record.collider) s.differ += 1;
+				s.max_t_delta = std::max(s.max_t_delta, std::abs(hit.t - record.t));
+			}
+		}
+		for (uint32_t k = 0; k < Kinds; ++k) {
+			stats[k].seconds = std::min(stats[k].seconds, seconds[k]);
+		}
+	}
+
+	if (collider_stats) {
+		collider_stats->next_frame();
+		collider_stats->save_csv(level.collision, stats_file);
+		std::cout << "Wrote per-collider cost to '" << stats_file << "'." << std::endl;
+	}
+
+	std::cout << "Best of " << repeats << " passes:" << std::endl;
+	for (uint32_t k = 0; k < Kinds; ++k) {
+		Stats const &s = stats[k];
+		if (s.count == 0) continue;
+		std::cout << "  " << std::left << std::setw(30) << (std::string(kind_names[k]) + ":")
+			<< s.count << " queries in " << s.seconds << "s ("
+			<< std::fixed << std::setprecision(3) << (s.seconds / s.count * 1e6) << "us each)";
+		std::cout.unsetf(std::ios::fixed);
+		std::cout << std::setprecision(6);
+		if (k == CollisionTrace::SlideSphere) {
+			std::cout << "; max end position difference " << s.max_position_delta << "." << std::endl;
+		} else {
+			std::cout << "; " << s.differ << " results differ, max t difference " << s.max_t_delta << "." << std::endl;
+		}
+	}
+
+	return 0;
+#ifdef _WIN32
+	} catch (std::exception &e) {
+		std::cerr << "UNHANDLED EXCEPTION:\n" << e.what() << std::endl;
+		return 1;
+	}
+#endif
+}
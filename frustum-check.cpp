@@ -0,0 +1,269 @@
+#include "Frustum.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <random>
+#include <string>
+
+/*
+ * frustum-check tests Frustum (as used by Scene::draw's culling) against
+ *  clip-space results, without opening a window or making a GL context:
+ *  (1) for each of the six planes (left, right, bottom, top, near, far), a box
+ *      just inside, one straddling, and one just outside that plane;
+ *  (2) random boxes (rotated, scaled, off-center bounds) around the view volume.
+ * Each is run with a finite and with an infinite far plane (where nothing is outside the far plane).
+ *
+ * Expected answers come from the box's eight corners in clip space (no plane extraction):
+ *  - every corner outside the same plane => overlaps_box must say 'false';
+ *  - some corner inside the view volume => overlaps_box must say 'true';
+ *  - otherwise (near a frustum edge or corner) either answer is allowed, since the test is conservative.
+ * (corners within float rounding of a plane count as neither inside nor outside it.)
+ * contains() is checked the same way on the box centers.
+ *
+ * usage: ./frustum-check [seed] [random-boxes]
+ * exits with status 1 if any answer is wrong.
+ *
+ */
+
+//a box as passed to Frustum::overlaps_box:
+struct Box {
+	glm::mat4 local_to_world;
+	glm::vec3 min, max;
+};
+
+//what the box's corners say about it, computed in clip space:
+enum Expect {
+	Outside, //all corners outside one plane
+	Inside, //some corner inside the view volume
+	Either, //neither (too close to an edge to say)
+};
+
+//clip-space distance of 'clip' inside plane 'p' (same order as Frustum::planes):
+static float inside_plane(glm::vec4 const &clip, uint32_t p) {
+	float coord = clip[p / 2];
+	return (p % 2 == 0 ? clip.w + coord : clip.w - coord);
+}
+
+//float rounding in the matrix products (either these or Frustum's) can put points within this of a plane on either side:
+static float tolerance(glm::vec4 const &clip) {
+	return 1e-5f * (std::abs(clip.w) + 1.0f);
+}
+
+static Expect classify(glm::mat4 const &world_to_clip, Box const &box) {
+	std::array< glm::vec4, 8 > corners;
+	for (uint32_t c = 0; c < 8; ++c) {
+		glm::vec3 local = glm::vec3(
+			(c & 1 ? box.max.x : box.min.x),
+			(c & 2 ? box.max.y : box.min.y),
+			(c & 4 ? box.max.z : box.min.z)
+		);
+		corners[c] = world_to_clip * box.local_to_world * glm::vec4(local, 1.0f);
+	}
+	for (uint32_t p = 0; p < 6; ++p) {
+		bool all_outside = true;
+		for (glm::vec4 const &clip : corners) {
+			if (inside_plane(clip, p) >= -tolerance(clip)) all_outside = false;
+		}
+		if (all_outside) return Outside;
+	}
+	for (glm::vec4 const &clip : corners) {
+		bool inside = true;
+		for (uint32_t p = 0; p < 6; ++p) {
+			if (inside_plane(clip, p) < tolerance(clip)) inside = false;
+		}
+		if (inside) return Inside;
+	}
+	return Either;
+}
+
+//is 'pt' Inside or Outside the view volume (or Either, if it is too close to a plane to say)?
+static Expect classify(glm::mat4 const &world_to_clip, glm::vec3 const &pt) {
+	glm::vec4 clip = world_to_clip * glm::vec4(pt, 1.0f);
+	Expect ret = Inside;
+	for (uint32_t p = 0; p < 6; ++p) {
+		float inside = inside_plane(clip, p);
+		if (inside < -tolerance(clip)) return Outside;
+		if (inside < tolerance(clip)) ret = Either;
+	}
+	return ret;
+}
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+	try { //windows doesn't print nice errors for unhandled exceptions, so we need to.
+#endif
+	uint32_t seed = (argc > 1 ? uint32_t(std::stoul(argv[1])) : 1);
+	uint32_t tests = (argc > 2 ? uint32_t(std::stoul(argv[2])) : 100000);
+	if (argc > 3) {
+		std::cerr << "Usage:\n\t./frustum-check [seed] [random-boxes]\n";
+		return 1;
+	}
+
+	//a camera off the axes, looking somewhere that isn't straight down an axis:
+	float const fovy = glm::radians(60.0f);
+	float const aspect = 16.0f / 9.0f;
+	float const z_near = 0.1f;
+	float const z_far = 100.0f;
+	glm::vec3 const eye = glm::vec3(3.0f, -7.0f, 2.0f);
+	glm::mat4 const world_to_view = glm::lookAt(eye, glm::vec3(-4.0f, 5.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+	glm::mat4 const view_to_world = glm::inverse(world_to_view);
+
+	uint32_t failures = 0;
+
+	struct Projection {
+		std::string name;
+		glm::mat4 view_to_clip;
+		bool infinite;
+	};
+	for (Projection const &projection : {
+		Projection{"finite far plane", glm::perspective(fovy, aspect, z_near, z_far), false},
+		Projection{"infinite far plane", glm::infinitePerspective(fovy, aspect, z_near), true},
+	}) {
+		std::cout << projection.name << ":" << std::endl;
+		glm::mat4 world_to_clip = projection.view_to_clip * world_to_view;
+		Frustum frustum(world_to_clip);
+
+		uint32_t wrong = 0;
+		uint32_t unsure = 0;
+		auto check = [&](Box const &box, Expect want, std::string const &what) {
+			Expect got = classify(world_to_clip, box);
+			if (want != Either && got != want) {
+				//the case itself was built wrong -- count it, so a broken check can't pass quietly:
+				std::cerr << "  " << what << ": box is not " << (want == Inside ? "inside" : "outside") << " as built." << std::endl;
+				++wrong;
+				return;
+			}
+			bool overlaps = frustum.overlaps_box(box.local_to_world, box.min, box.max);
+			if ((got == Outside && overlaps) || (got == Inside && !overlaps)) {
+				if (!what.empty()) std::cerr << "  " << what << ": overlaps_box said " << (overlaps ? "true" : "false") << "." << std::endl;
+				++wrong;
+			}
+			if (got == Either) ++unsure;
+
+			glm::vec3 center = glm::vec3(box.local_to_world * glm::vec4(0.5f * (box.min + box.max), 1.0f));
+			Expect center_in = classify(world_to_clip, center);
+			if (center_in != Either && frustum.contains(center) != (center_in == Inside)) {
+				if (!what.empty()) std::cerr << "  " << what << ": contains(center) disagrees." << std::endl;
+				++wrong;
+			}
+		};
+
+		//--- (1): boxes placed against each plane ---
+		{
+			uint32_t before = wrong;
+			uint32_t cases = 0;
+			//view-space extent at depth 'd' (camera looks down -z):
+			float const tan_y = std::tan(0.5f * fovy);
+			float const tan_x = tan_y * aspect;
+			char const *plane_names[6] = {"left", "right", "bottom", "top", "near", "far"};
+			for (uint32_t p = 0; p < 6; ++p) {
+				if (p == 5 && projection.infinite) continue; //(no far plane to be outside of)
+				for (int32_t side = -1; side <= 1; ++side) {
+					//center of the plane's face, and the direction out of the frustum through it:
+					glm::vec3 at, out;
+					float half; //half-size of the box, well under the distance to any other plane
+					if (p < 4) {
+						float d = 10.0f;
+						float sign = (p % 2 == 0 ? -1.0f : 1.0f);
+						if (p < 2) {
+							at = glm::vec3(sign * tan_x * d, 0.0f, -d);
+							out = glm::normalize(glm::vec3(sign, 0.0f, tan_x));
+						} else {
+							at = glm::vec3(0.0f, sign * tan_y * d, -d);
+							out = glm::normalize(glm::vec3(0.0f, sign, tan_y));
+						}
+						half = 0.5f;
+					} else if (p == 4) {
+						at = glm::vec3(0.0f, 0.0f, -z_near);
+						out = glm::vec3(0.0f, 0.0f, 1.0f);
+						half = 0.25f * z_near;
+					} else {
+						at = glm::vec3(0.0f, 0.0f, -z_far);
+						out = glm::vec3(0.0f, 0.0f, -1.0f);
+						half = 0.05f * z_far;
+					}
+					//inside, straddling, or outside (by a bit more than the box's half-diagonal):
+					glm::vec3 center = at + float(side) * (2.0f * half) * out;
+
+					//a rotated, non-uniformly scaled box with off-center bounds, centered at 'center':
+					glm::quat rotation = glm::angleAxis(0.7f + float(p), glm::normalize(glm::vec3(1.0f, -2.0f, 0.5f)));
+					glm::vec3 scale = glm::vec3(0.5f, 1.0f, 2.0f);
+					glm::vec3 offset = glm::vec3(3.0f, -1.0f, 0.5f);
+					Box box;
+					box.min = offset - half / scale * (1.0f / std::sqrt(3.0f));
+					box.max = offset + half / scale * (1.0f / std::sqrt(3.0f));
+					glm::mat4 local_to_view = glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+					glm::vec3 local_center = glm::vec3(local_to_view * glm::vec4(offset, 1.0f));
+					local_to_view = glm::translate(glm::mat4(1.0f), center - local_center) * local_to_view;
+					box.local_to_world = view_to_world * local_to_view;
+
+					//(a straddling box has corners on both sides, so some of it is in view)
+					Expect want = (side > 0 ? Outside : Inside);
+					std::string what = std::string(plane_names[p]) + (side < 0 ? " (inside)" : side > 0 ? " (outside)" : " (straddling)");
+					check(box, want, what);
+					++cases;
+				}
+			}
+
+			//with an infinite projection, boxes far beyond where a finite far plane would be stay visible:
+			if (projection.infinite) {
+				for (float d : {2.0f * z_far, 1.0e4f}) {
+					Box box;
+					box.min = glm::vec3(-1.0f);
+					box.max = glm::vec3(1.0f);
+					box.local_to_world = view_to_world * glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -d));
+					check(box, Inside, "beyond " + std::to_string(int32_t(d)));
+					++cases;
+				}
+			}
+			std::cout << std::setw(30) << "  planes:" << cases << " boxes; " << (wrong - before) << " wrong." << std::endl;
+		}
+
+		//--- (2): random boxes around the view volume ---
+		{
+			uint32_t before = wrong;
+			unsure = 0;
+			std::mt19937 mt(seed);
+			auto uniform = [&mt](float lo, float hi) {
+				return std::uniform_real_distribution< float >(lo, hi)(mt);
+			};
+			for (uint32_t i = 0; i < tests; ++i) {
+				//somewhere from behind the camera to past the far plane, out past the sides:
+				float d = uniform(-10.0f, 1.2f * z_far);
+				glm::vec3 center = glm::vec3(uniform(-1.5f, 1.5f) * d, uniform(-1.0f, 1.0f) * d, -d);
+				glm::quat rotation = glm::normalize(glm::quat(uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f), uniform(-1.0f, 1.0f)));
+				glm::vec3 scale = glm::vec3(uniform(0.2f, 3.0f), uniform(0.2f, 3.0f), uniform(0.2f, 3.0f));
+				glm::vec3 a = glm::vec3(uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f), uniform(-3.0f, 3.0f));
+				glm::vec3 b = a + glm::vec3(uniform(0.0f, 4.0f), uniform(0.0f, 4.0f), uniform(0.0f, 4.0f));
+				Box box;
+				box.min = a;
+				box.max = b;
+				box.local_to_world = view_to_world * glm::translate(glm::mat4(1.0f), center)
+					* glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+				check(box, Either, "");
+			}
+			std::cout << std::setw(30) << "  random boxes:" << tests << " boxes; " << (wrong - before) << " wrong, "
+				<< unsure << " near an edge (either answer allowed)." << std::endl;
+		}
+
+		failures += wrong;
+	}
+
+	if (failures) {
+		std::cerr << failures << " Frustum answers differ from clip space!" << std::endl;
+		return 1;
+	}
+	return 0;
+#ifdef _WIN32
+	} catch (std::exception &e) {
+		std::cerr << "UNHANDLED EXCEPTION:\n" << e.what() << std::endl;
+		return 1;
+	}
+#endif
+}
@@ -1,12 +1,16 @@
 //Mode.hpp declares the "Mode::current" static member variable, which is used to decide where event-handling, updating, and drawing events go:
 #include "Mode.hpp"
 
-//Starting mode:
+//Starting modes:
 #include "FlyMode.hpp"
+#include "RollMode.hpp"
 
 //Deal with calling resource loading functions:
 #include "Load.hpp"
 
+//Per-frame transform caching:
+#include "Scene.hpp"
+
 //GL.hpp will include a non-namespace-polluting set of opengl prototypes:
 #include "GL.hpp"
 
@@ -25,6 +29,8 @@
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <iterator>
+#include <string>
 
 int main(int argc, char **argv) {
 #ifdef _WIN32
@@ -107,19 +113,24 @@ int main(int argc, char **argv) {
 	call_load_functions();
 
 	//------------ create game mode + make current --------------
-	if (argc > 1) {
-		int32_t level = -1;
-		if (argc >= 2) level = std::stoi(argv[1]);
-		if (argc != 2 || level < 0 || level >= int32_t(fly_levels->size())) {
-			std::cerr << "Usage:\n\t" << argv[0] << " [level number]" << std::endl;
-		}
+	//(the optional first argument "roll" plays the Sphere Roll levels instead of the Fly levels)
+	bool roll = (argc > 1 && std::string(argv[1]) == "roll");
+	int32_t level_arg = (roll ? 2 : 1);
+	int32_t level_count = int32_t(roll ? roll_levels->size() : fly_levels->size());
+	int32_t level = 0;
+	if (argc > level_arg) level = std::stoi(argv[level_arg]);
+	if (argc > level_arg + 1 || level < 0 || level >= level_count) {
+		std::cerr << "Usage:\n\t" << argv[0] << " [roll] [level number]" << std::endl;
+		return 1;
+	}
+	if (roll) {
+		auto level_iter = roll_levels->begin();
+		std::advance(level_iter, level);
+		Mode::set_current(std::make_shared< RollMode >(*level_iter));
+	} else {
 		auto level_iter = fly_levels->begin();
-		for (int32_t i = 0; i < level; ++i) {
-			++level_iter;
-		}
+		std::advance(level_iter, level);
 		Mode::set_current(std::make_shared< FlyMode >(*level_iter));
-	} else {
-		Mode::set_current(std::make_shared< FlyMode >(fly_levels->front()));
 	}
 
 	//------------ main loop ------------
@@ -144,6 +155,9 @@ int main(int argc, char **argv) {
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
 
+		//(cached world matrices are checked against their transforms' ancestors again, once, in each new frame)
+		Scene::Transform::next_frame();
+
 		{ //(1) process any events that are pending
 			static SDL_Event evt;
 			while (SDL_PollEvent(&evt) == 1) {
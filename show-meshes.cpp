@@ -3,6 +3,7 @@
 #include "Load.hpp"
 #include "GL.hpp"
 #include "load_save_png.hpp"
+#include "Scene.hpp"
 
 #include <SDL.h>
 
@@ -123,6 +124,9 @@ int main(int argc, char **argv) {
 		//every pass through the game loop creates one frame of output
 		//  by performing three steps:
 
+		//(cached world matrices are checked against their transforms' ancestors again, once, in each new frame)
+		Scene::Transform::next_frame();
+
 		{ //(1) process any events that are pending
 			static SDL_Event evt;
 			while (SDL_PollEvent(&evt) == 1) {
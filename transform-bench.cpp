@@ -0,0 +1,155 @@
+#include "Scene.hpp"
+#include "TransformStore.hpp"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * transform-bench times world matrix updates of large synthetic hierarchies,
+ *  without opening a window or making a GL context:
+ *  - "chain": every transform is the child of the one before (as deep as possible),
+ *  - "fan": every transform is a child of one root (as wide as possible),
+ *  - "tree": every transform has 'branching' children (in between; closer to a city-sized export).
+ * For each, it compares:
+ *  (a) walking to the root and multiplying matrices for every transform (as make_local_to_world did before caching),
+ *  (b) Scene::Transform::make_local_to_world for every transform, in a new frame after the root moved (so every cache is stale),
+ *  (c) TransformStore::update (one linear pass),
+ *  (d) TransformStore::update_parallel (depth levels split across threads).
+ * (a) costs O(depth) per transform, so on deep hierarchies it is timed on a sample of transforms and scaled up.
+ *
+ * usage: ./transform-bench [transforms] [threads]
+ *
+ */
+
+template< typename F >
+static double time_seconds(F const &fn) {
+	auto before = std::chrono::high_resolution_clock::now();
+	fn();
+	auto after = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration< double >(after - before).count();
+}
+
+//local-to-world by multiplying up the chain of parents (no caching):
+static glm::mat4 walk_to_root(Scene::Transform const &transform) {
+	glm::mat4 ret = transform.make_local_to_parent();
+	for (Scene::Transform const *t = transform.parent; t; t = t->parent) {
+		ret = t->make_local_to_parent() * ret;
+	}
+	return ret;
+}
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+	try { //windows doesn't print nice errors for unhandled exceptions, so we need to.
+#endif
+	uint32_t count = (argc > 1 ? uint32_t(std::stoul(argv[1])) : 200000);
+	uint32_t threads = (argc > 2 ? uint32_t(std::stoul(argv[2])) : 0);
+	if (argc > 3 || count < 2) {
+		std::cerr << "Usage:\n\t./transform-bench [transforms] [threads]\n";
+		return 1;
+	}
+	std::cout << count << " transforms per hierarchy, "
+		<< (threads ? threads : std::max(1U, std::thread::hardware_concurrency())) << " threads." << std::endl;
+
+	//results are summed into this so the compiler can't skip the work:
+	float checksum = 0.0f;
+
+	struct Shape {
+		std::string name;
+		uint32_t branching; //children per transform (0 for a fan)
+	};
+	for (Shape const &shape : {Shape{"chain", 1}, Shape{"fan", 0}, Shape{"tree", 8}}) {
+		//build scene (in topological order, as Scene::load would):
+		Scene scene;
+		std::vector< Scene::Transform * > transforms;
+		transforms.reserve(count);
+		uint32_t depth = 0;
+		for (uint32_t i = 0; i < count; ++i) {
+			scene.transforms.emplace_back();
+			Scene::Transform *t = &scene.transforms.back();
+			//small, varied offsets (so long chains don't run off to huge coordinates):
+			t->position = glm::vec3(0.01f * float(i % 7), 0.01f * float(i % 5), 0.01f);
+			t->rotation = glm::angleAxis(0.001f * float(i % 11), glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f)));
+			if (i > 0) {
+				uint32_t parent = (shape.branching == 0 ? 0 : (i - 1) / shape.branching);
+				t->parent = transforms[parent];
+			}
+			transforms.emplace_back(t);
+		}
+		for (Scene::Transform const *t = transforms.back(); t->parent; t = t->parent) {
+			depth += 1;
+		}
+
+		TransformStore store;
+		store.threads = threads;
+		std::vector< TransformStore::Handle > handles = store.add_scene(scene);
+		store.update_parallel(); //(first call sorts by depth; later calls don't)
+
+		std::cout << "Hierarchy '" << shape.name << "': " << count << " transforms, " << (depth + 1) << " deep." << std::endl;
+
+		//(a) samples every 'stride'th transform when a full pass would be too slow:
+		uint64_t work = (shape.branching == 1 ? uint64_t(count) * count / 2 : uint64_t(count) * (depth + 1));
+		uint32_t stride = uint32_t(std::max< uint64_t >(1, work / 20000000));
+		std::string sampled = (stride > 1 ? " (sampled every " + std::to_string(stride) + "th transform)" : "");
+
+		double walk_seconds = time_seconds([&](){
+			for (uint32_t i = 0; i < count; i += stride) {
+				checksum += walk_to_root(*transforms[i])[3].x;
+			}
+		}) * stride;
+
+		transforms[0]->position.x += 1.0f;
+		Scene::Transform::next_frame();
+		double cached_seconds = time_seconds([&](){
+			for (uint32_t i = 0; i < count; ++i) {
+				checksum += transforms[i]->make_local_to_world()[3].x;
+			}
+		});
+
+		store.position(handles[0]).x += 1.0f;
+		double update_seconds = time_seconds([&](){
+			store.update();
+		});
+		double parallel_seconds = 1e30;
+		for (uint32_t repeat = 0; repeat < 5; ++repeat) {
+			parallel_seconds = std::min(parallel_seconds, time_seconds([&](){
+				store.update_parallel();
+			}));
+		}
+
+		//check store against scene:
+		float max_difference = 0.0f;
+		for (uint32_t i = 0; i < count; ++i) {
+			glm::mat4 expected = transforms[i]->make_local_to_world();
+			glm::mat4x3 const &got = store.local_to_world(handles[i]);
+			for (uint32_t c = 0; c < 4; ++c) {
+				max_difference = std::max(max_difference, glm::length(glm::vec3(expected[c]) - got[c]));
+			}
+		}
+		checksum += store.local_to_world(handles.back())[3].x;
+
+		std::cout << std::left;
+		std::cout << std::setw(48) << "  walk to root, per transform:" << walk_seconds << "s" << sampled << std::endl;
+		std::cout << std::setw(48) << "  make_local_to_world (cached), per transform:" << cached_seconds << "s" << std::endl;
+		std::cout << std::setw(48) << "  TransformStore::update:" << update_seconds << "s" << std::endl;
+		std::cout << std::setw(48) << "  TransformStore::update_parallel:" << parallel_seconds << "s ("
+			<< (store.level_starts.size() - 1) << " levels); max difference from Scene " << max_difference << "." << std::endl;
+	}
+
+	std::cout << "(checksum " << checksum << ")" << std::endl;
+
+	return 0;
+#ifdef _WIN32
+	} catch (std::exception &e) {
+		std::cerr << "UNHANDLED EXCEPTION:\n" << e.what() << std::endl;
+		return 1;
+	}
+#endif
+}